@@ -0,0 +1,558 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "jston.h"
+
+// microbenchmarks for jston conversions
+// every case reports ns/op, bytes/sec (JSON text size per op) and heap allocations/op, and all results can be written
+// to a JSON file for regression tracking:
+//   ./jston_bench [--filter=<substring>] [--min_time=<seconds>] [--out=<results.json>]
+
+// allocation counting hook, replaces the global allocation functions for this benchmark binary only
+static std::atomic<uint64_t> g_allocations{0};
+static std::atomic<uint64_t> g_allocated_bytes{0};
+
+// one allocation function and one deallocation function back every form of new and delete, so that all of them
+// agree on malloc and free; both are kept out of line because GCC flags them once inlined into callers
+// (-Wmismatched-new-delete, -Walloc-size-larger-than)
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+static void* counted_malloc(std::size_t size) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+static void counted_free(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void* operator new(std::size_t size) {
+    if (void* ptr = counted_malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return counted_malloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return counted_malloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    counted_free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    counted_free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    counted_free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    counted_free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    counted_free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    counted_free(ptr);
+}
+
+// keep the optimizer from discarding benchmark results
+template <typename T>
+inline void do_not_optimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// benchmark structs, one per TYPE_CODE family
+// ---------------------------------------------------------------------------------------------------------------------
+
+struct ScalarStruct {
+    char c;
+    short s;
+    int i;
+    long l;
+    long long ll;
+    unsigned short us;
+    unsigned int ui;
+    unsigned long ul;
+    unsigned long long ull;
+    float f;
+    double d;
+    bool b;
+};
+register_json_struct(ScalarStruct, c, s, i, l, ll, us, ui, ul, ull, f, d, b);
+
+struct CharArrayStruct {
+    char short_text[16];
+    char name[64];
+    char description[256];
+};
+register_json_struct(CharArrayStruct, short_text, name, description);
+
+struct NumericArrayStruct {
+    int ints[256];
+    double doubles[256];
+    float floats[64];
+    short shorts[64];
+    bool flags[64];
+};
+register_json_struct(NumericArrayStruct, ints, doubles, floats, shorts, flags);
+
+struct Car {
+    int id;
+    double price;
+    char brand[32];
+    char model[32];
+};
+register_json_struct(Car, id, price, brand, model);
+
+struct Person {
+    int age;
+    char name[32];
+    Car car;
+    int phone_numbers[5];
+};
+register_json_struct(Person, age, name, car, phone_numbers);
+
+struct Department {
+    char name[32];
+    Person employees[20];
+    int count;
+};
+register_json_struct(Department, name, employees, count);
+
+// department export with thousands of employees, about 2 MB of text; a decode that leaves employees out skips the
+// array in classified 64-byte blocks
+struct DepartmentExport {
+    char name[32];
+    std::vector<Person> employees;
+};
+register_json_struct(DepartmentExport, name, employees);
+
+struct Level5 {
+    int id;
+    char name[16];
+    double value;
+};
+register_json_struct(Level5, id, name, value);
+
+struct Level4 {
+    int id;
+    char name[16];
+    Level5 items[3];
+};
+register_json_struct(Level4, id, name, items);
+
+struct Level3 {
+    int id;
+    char name[16];
+    Level4 items[2];
+};
+register_json_struct(Level3, id, name, items);
+
+struct Level2 {
+    int id;
+    char name[16];
+    Level3 items[2];
+};
+register_json_struct(Level2, id, name, items);
+
+struct Level1 {
+    int id;
+    char name[16];
+    Level2 items[2];
+};
+register_json_struct(Level1, id, name, items);
+
+// same layout as PerformanceTestStruct in test/test_advanced.cpp
+struct PerformanceStruct {
+    int array[1000];
+    double double_array[500];
+};
+register_json_struct(PerformanceStruct, array, double_array);
+
+// large floating point corpus, mostly 15 to 17 significant digits
+struct DoubleCorpus {
+    std::vector<double> values;
+};
+register_json_struct(DoubleCorpus, values);
+
+// ---------------------------------------------------------------------------------------------------------------------
+// fixtures
+// ---------------------------------------------------------------------------------------------------------------------
+
+static ScalarStruct make_scalar() {
+    ScalarStruct value;
+    value.c = 'x';
+    value.s = -1234;
+    value.i = 123456789;
+    value.l = -9876543210L;
+    value.ll = 1234567890123456789LL;
+    value.us = 65000;
+    value.ui = 4000000000U;
+    value.ul = 18000000000000000000UL;
+    value.ull = 18446744073709551615ULL;
+    value.f = 3.14159f;
+    value.d = 2.718281828459045;
+    value.b = true;
+    return value;
+}
+
+static CharArrayStruct make_char_array() {
+    CharArrayStruct value;
+    memset(&value, 0, sizeof(value));
+    strcpy(value.short_text, "short");
+    strcpy(value.name, "a moderately long name used for benchmarking");
+    for (size_t i = 0; i < sizeof(value.description) - 1; ++i) {
+        value.description[i] = static_cast<char>('a' + i % 26);
+    }
+    return value;
+}
+
+static NumericArrayStruct make_numeric_array() {
+    NumericArrayStruct value;
+    for (int i = 0; i < 256; ++i) {
+        value.ints[i] = i * 7919 - 100000;
+        value.doubles[i] = i * 1.1 + 0.001;
+    }
+    for (int i = 0; i < 64; ++i) {
+        value.floats[i] = i * 0.5f + 0.25f;
+        value.shorts[i] = static_cast<short>(i * 100 - 3000);
+        value.flags[i] = (i & 1) != 0;
+    }
+    return value;
+}
+
+static Person make_person(int seed) {
+    Person value;
+    memset(&value, 0, sizeof(value));
+    value.age = 20 + seed % 40;
+    snprintf(value.name, sizeof(value.name), "Employee %d", seed);
+    value.car.id = 1000 + seed;
+    value.car.price = 20000.5 + seed;
+    strcpy(value.car.brand, "Toyota");
+    strcpy(value.car.model, "Camry");
+    for (int i = 0; i < 5; ++i) {
+        value.phone_numbers[i] = 100000000 + seed * 10 + i;
+    }
+    return value;
+}
+
+static Department make_department() {
+    Department value;
+    memset(&value, 0, sizeof(value));
+    strcpy(value.name, "Engineering");
+    for (int i = 0; i < 20; ++i) {
+        value.employees[i] = make_person(i);
+    }
+    value.count = 20;
+    return value;
+}
+
+static DepartmentExport make_department_export(int count) {
+    DepartmentExport value;
+    memset(value.name, 0, sizeof(value.name));
+    strcpy(value.name, "Engineering");
+    for (int i = 0; i < count; ++i) {
+        value.employees.push_back(make_person(i));
+    }
+    return value;
+}
+
+static Level1 make_nested() {
+    Level1 value;
+    memset(&value, 0, sizeof(value));
+    value.id = 1;
+    strcpy(value.name, "Level1");
+    for (int i = 0; i < 2; i++) {
+        value.items[i].id = i + 100;
+        snprintf(value.items[i].name, sizeof(value.items[i].name), "Level2_%d", i);
+        for (int j = 0; j < 2; j++) {
+            Level3& level3 = value.items[i].items[j];
+            level3.id = i * 1000 + j;
+            snprintf(level3.name, sizeof(level3.name), "Level3_%d_%d", i, j);
+            for (int k = 0; k < 2; k++) {
+                Level4& level4 = level3.items[k];
+                level4.id = i * 10000 + j * 1000 + k;
+                snprintf(level4.name, sizeof(level4.name), "Level4_%d_%d_%d", i, j, k);
+                for (int l = 0; l < 3; l++) {
+                    Level5& level5 = level4.items[l];
+                    level5.id = i * 100000 + j * 10000 + k * 1000 + l;
+                    snprintf(level5.name, sizeof(level5.name), "L5_%d_%d_%d_%d", i, j, k, l);
+                    level5.value = (i * 100 + j * 10 + k) * 1.1 + l * 0.5;
+                }
+            }
+        }
+    }
+    return value;
+}
+
+static PerformanceStruct make_performance() {
+    PerformanceStruct value;
+    for (int i = 0; i < 1000; ++i) {
+        value.array[i] = i;
+    }
+    for (int i = 0; i < 500; ++i) {
+        value.double_array[i] = i * 3.14159;
+    }
+    return value;
+}
+
+static DoubleCorpus make_double_corpus(size_t count) {
+    DoubleCorpus value;
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-30, 30);
+    value.values.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        value.values.push_back(std::ldexp(mantissa(rng), exponent(rng)));
+    }
+    return value;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// harness
+// ---------------------------------------------------------------------------------------------------------------------
+
+struct bench_case {
+    std::string name;
+    size_t bytes_per_op;                // size of the JSON text handled per operation
+    std::function<void(uint64_t)> run;  // runs the operation the given number of times
+};
+
+struct bench_result {
+    std::string name;
+    uint64_t iterations;
+    double ns_per_op;
+    double bytes_per_second;
+    double allocations_per_op;
+    double allocated_bytes_per_op;
+};
+
+static std::vector<bench_case>& registry() {
+    static std::vector<bench_case> cases;
+    return cases;
+}
+
+// register to_json / from_json / to_json_string / from_json_string cases for one struct fixture, plus a
+// from_json_string case over sorted keys for comparison with registration order input
+template <typename T>
+static void register_type(const std::string& type_name, const T& fixture) {
+    auto value = std::make_shared<T>(fixture);
+    auto dom = std::make_shared<nlohmann::json>(jston::to_json(*value));
+    auto text = std::make_shared<std::string>(jston::to_json_string(*value));
+    const size_t bytes = text->size();
+
+    registry().push_back({type_name + "/to_json", bytes, [value](uint64_t n) {
+                              for (uint64_t i = 0; i < n; ++i) {
+                                  nlohmann::json j = jston::to_json(*value);
+                                  do_not_optimize(j);
+                              }
+                          }});
+    registry().push_back({type_name + "/from_json", bytes, [dom](uint64_t n) {
+                              T out;
+                              for (uint64_t i = 0; i < n; ++i) {
+                                  jston::from_json(*dom, out);
+                                  do_not_optimize(out);
+                              }
+                          }});
+    registry().push_back({type_name + "/to_json_string", bytes, [value](uint64_t n) {
+                              for (uint64_t i = 0; i < n; ++i) {
+                                  std::string s = jston::to_json_string(*value);
+                                  do_not_optimize(s);
+                              }
+                          }});
+    registry().push_back({type_name + "/from_json_string", bytes, [text](uint64_t n) {
+                              T out;
+                              for (uint64_t i = 0; i < n; ++i) {
+                                  jston::from_json_string(*text, out);
+                                  do_not_optimize(out);
+                              }
+                          }});
+    // same decode with the text fed in 4 KB pieces, the way a socket reader receives it
+    registry().push_back({type_name + "/decoder_4k_chunks", bytes, [text](uint64_t n) {
+                              T out;
+                              jston::decoder<T> decoder(out);
+                              for (uint64_t i = 0; i < n; ++i) {
+                                  decoder.reset(out);
+                                  for (size_t pos = 0; pos < text->size(); pos += 4096) {
+                                      decoder.feed(text->data() + pos, std::min<size_t>(4096, text->size() - pos));
+                                  }
+                                  do_not_optimize(out);
+                              }
+                          }});
+    // bounded types can also be written into a stack buffer without heap allocation
+    if constexpr (jston::max_json_size<T> > 0) {
+        registry().push_back({type_name + "/serialize_to", bytes, [value](uint64_t n) {
+                                  char buffer[jston::max_json_size<T> + 1];
+                                  for (uint64_t i = 0; i < n; ++i) {
+                                      size_t length = jston::serialize_to(buffer, *value);
+                                      do_not_optimize(length);
+                                      do_not_optimize(buffer);
+                                  }
+                              }});
+    }
+    // same decode from text with alphabetically sorted keys, which defeats the registration order speculation
+    auto sorted_text = std::make_shared<std::string>(dom->dump());
+    registry().push_back({type_name + "/from_json_string_sorted_keys", bytes, [sorted_text](uint64_t n) {
+                              T out;
+                              for (uint64_t i = 0; i < n; ++i) {
+                                  jston::from_json_string(*sorted_text, out);
+                                  do_not_optimize(out);
+                              }
+                          }});
+}
+
+static double elapsed_ns(const bench_case& c, uint64_t iterations) {
+    const auto start = std::chrono::steady_clock::now();
+    c.run(iterations);
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// grow the iteration count until a run takes at least min_time, like google benchmark does
+static bench_result run_case(const bench_case& c, double min_time_seconds) {
+    c.run(1);  // warm up caches and lazy initialization
+    const double min_time_ns = min_time_seconds * 1e9;
+    uint64_t iterations = 1;
+    for (;;) {
+        const uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+        const uint64_t bytes_before = g_allocated_bytes.load(std::memory_order_relaxed);
+        const double ns = elapsed_ns(c, iterations);
+        const uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - allocations_before;
+        const uint64_t allocated_bytes = g_allocated_bytes.load(std::memory_order_relaxed) - bytes_before;
+
+        if (ns >= min_time_ns || iterations >= (uint64_t(1) << 40)) {
+            bench_result result;
+            result.name = c.name;
+            result.iterations = iterations;
+            result.ns_per_op = ns / iterations;
+            result.bytes_per_second = c.bytes_per_op * iterations / (ns / 1e9);
+            result.allocations_per_op = static_cast<double>(allocations) / iterations;
+            result.allocated_bytes_per_op = static_cast<double>(allocated_bytes) / iterations;
+            return result;
+        }
+        // predict the iteration count needed to reach min_time, with some headroom and bounded growth
+        const double multiplier = ns > 0 ? std::min(10.0, std::max(1.5, min_time_ns * 1.4 / ns)) : 10.0;
+        iterations = static_cast<uint64_t>(iterations * multiplier) + 1;
+    }
+}
+
+static std::string format_rate(double bytes_per_second) {
+    char buffer[32];
+    if (bytes_per_second >= 1024.0 * 1024.0 * 1024.0) {
+        snprintf(buffer, sizeof(buffer), "%.2f GiB/s", bytes_per_second / (1024.0 * 1024.0 * 1024.0));
+    } else if (bytes_per_second >= 1024.0 * 1024.0) {
+        snprintf(buffer, sizeof(buffer), "%.2f MiB/s", bytes_per_second / (1024.0 * 1024.0));
+    } else {
+        snprintf(buffer, sizeof(buffer), "%.2f KiB/s", bytes_per_second / 1024.0);
+    }
+    return buffer;
+}
+
+int main(int argc, char** argv) {
+    std::string filter;
+    std::string out_path;
+    double min_time = 0.2;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--filter=", 0) == 0) {
+            filter = arg.substr(9);
+        } else if (arg.rfind("--min_time=", 0) == 0) {
+            min_time = std::atof(arg.c_str() + 11);
+        } else if (arg.rfind("--out=", 0) == 0) {
+            out_path = arg.substr(6);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--filter=<substring>] [--min_time=<seconds>] [--out=<file>]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+#ifndef __OPTIMIZE__
+    std::cerr << "warning: jston_bench was built without optimization, configure with -DCMAKE_BUILD_TYPE=Release"
+              << std::endl;
+#endif
+
+    register_type("scalars", make_scalar());
+    register_type("char_array", make_char_array());
+    register_type("numeric_array", make_numeric_array());
+    register_type("struct_array", make_department());
+    register_type("department_export", make_department_export(10000));
+    register_type("nested_level1", make_nested());
+    register_type("nested_level4", make_nested().items[0].items[0].items[0]);
+    register_type("nested_level5", make_nested().items[0].items[0].items[0].items[0]);
+    register_type("performance_struct", make_performance());
+    register_type("double_corpus_1m", make_double_corpus(1000000));
+
+    printf("%-36s %14s %12s %14s %12s %12s\n", "benchmark", "iterations", "ns/op", "bytes/sec", "allocs/op",
+           "alloc B/op");
+    std::vector<bench_result> results;
+    for (const auto& c : registry()) {
+        if (!filter.empty() && c.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        const bench_result r = run_case(c, min_time);
+        printf("%-36s %14llu %12.1f %14s %12.1f %12.1f\n", r.name.c_str(),
+               static_cast<unsigned long long>(r.iterations), r.ns_per_op, format_rate(r.bytes_per_second).c_str(),
+               r.allocations_per_op, r.allocated_bytes_per_op);
+        results.push_back(r);
+    }
+
+    if (!out_path.empty()) {
+        nlohmann::json report;
+        report["context"]["min_time"] = min_time;
+#ifdef __OPTIMIZE__
+        report["context"]["optimized"] = true;
+#else
+        report["context"]["optimized"] = false;
+#endif
+        report["benchmarks"] = nlohmann::json::array();
+        for (const auto& r : results) {
+            nlohmann::json entry;
+            entry["name"] = r.name;
+            entry["iterations"] = r.iterations;
+            entry["ns_per_op"] = r.ns_per_op;
+            entry["bytes_per_second"] = r.bytes_per_second;
+            entry["allocations_per_op"] = r.allocations_per_op;
+            entry["allocated_bytes_per_op"] = r.allocated_bytes_per_op;
+            report["benchmarks"].push_back(entry);
+        }
+        std::ofstream out(out_path);
+        out << report.dump(2) << std::endl;
+        if (!out) {
+            std::cerr << "failed to write results to " << out_path << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
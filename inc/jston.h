@@ -1,16 +1,55 @@
 ﻿#ifndef __JSTON_H__
 #define __JSTON_H__
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cfloat>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <nlohmann/json.hpp>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <typeinfo>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#if defined(__GNUG__) || defined(__clang__)
+#include <cxxabi.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#endif
+
+// encode_chunks is a coroutine, available when the header is compiled as C++20
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && __has_include(<coroutine>)
+#include <coroutine>
+#include <iterator>
+#define JSTON_HAS_COROUTINES 1
+#endif
+
 /**
  * jston - a simple and easy-to-use C++ struct to JSON conversion framework
  * features:
@@ -33,6 +72,8 @@ enum class TYPE_CODE {
     U_INT = 0x07,
     U_LONG = 0x08,
     U_LONG_LONG = 0x09,
+    S_CHAR = 0x0A,  // signed char / int8_t
+    U_CHAR = 0x0B,  // unsigned char / uint8_t
     FLOAT = 0x10,
     DOUBLE = 0x11,
     BOOL = 0x12,      // boolean type
@@ -40,9 +81,83 @@ enum class TYPE_CODE {
     FUNCTION = 0x14,  // function pointer
     STRUCT = 0x15,    // nested struct
     ARRAY = 0x16,     // array
-    POINTER = 0x17    // pointer type
+    POINTER = 0x17,   // pointer type
+    STD_STRING = 0x18,  // std::string
+    STRING_VIEW = 0x19, // std::string_view, points into caller owned storage
+    VECTOR = 0x1A,      // std::vector, element type described like arrays
+    OPTIONAL = 0x1B,    // std::optional, value type in sub_type_code, absent values are not emitted
+    ENUM = 0x1C,        // enum, emitted as its name when registered with register_json_enum, else as an integer
+    MAP = 0x1D          // std::map / std::unordered_map / sorted flat vector keyed by std::string, a JSON object
+};
+
+// JSON representation of a one-dimensional array of 1-byte integers
+enum class BYTES_FORMAT : uint8_t {
+    ARRAY = 0,   // JSON array of numbers, like every other array
+    BASE64 = 1,  // one base64 string (standard alphabet, padded)
+    HEX = 2      // one lowercase hex string, two digits per byte
+};
+
+// type erased access to a std::vector member
+// elements are reached through data(), except for std::vector<bool> which has no element storage and uses
+// get_bool / set_bool instead
+struct sequence_ops {
+    size_t (*size)(const void* sequence);
+    void (*resize)(void* sequence, size_t size);  // keeps the capacity, existing elements are reused
+    const void* (*data)(const void* sequence);     // null for std::vector<bool>
+    void* (*mutable_data)(void* sequence);         // null for std::vector<bool>
+    bool (*get_bool)(const void* sequence, size_t index);
+    void (*set_bool)(void* sequence, size_t index, bool value);
+};
+
+// type erased access to a std::optional member
+struct optional_ops {
+    bool (*has_value)(const void* optional);
+    const void* (*value)(const void* optional);  // null when empty
+    void* (*emplace)(void* optional);            // engages an empty optional with a value initialized value
+    void (*reset)(void* optional);
+};
+
+// position in a map walked entry by entry through map_ops, holds the container's const_iterator
+struct map_cursor {
+    alignas(std::max_align_t) unsigned char storage[4 * sizeof(void*)];
+};
+
+// type erased access to an associative member keyed by std::string
+struct map_ops {
+    using visitor = void (*)(void* context, std::string_view key, const void* value);
+
+    size_t (*size)(const void* map);
+    void (*clear)(void* map);
+    void (*reserve)(void* map, size_t count);  // null when the container cannot reserve (std::map)
+    void (*for_each)(const void* map, visitor visit, void* context);
+    // walk that can be suspended between entries; both are null when the iterator does not fit a map_cursor
+    void (*first)(const void* map, map_cursor& cursor);
+    bool (*next)(const void* map, map_cursor& cursor, std::string_view& key, const void*& value);  // false at the end
+    void* (*emplace)(void* map, std::string_view key);  // value of the key, value initialized when the key is new
+    void (*finish)(void* map);                         // restores the key order of flat maps after decoding
+};
+
+// name and value of one enumerator
+struct enum_entry {
+    const char* name;
+    long long value;
 };
 
+// type erased access to an enum member and to the enumerators registered for its type
+struct enum_ops {
+    long long (*get)(const void* value);
+    void (*set)(void* value, long long raw);
+    bool (*in_range)(long long raw);                           // false when raw does not fit the underlying type
+    const char* (*name_of)(long long raw);                     // null for values without a registered name
+    bool (*value_of)(std::string_view name, long long& raw);  // false for unknown names
+    bool as_name;                                              // emit names instead of integer values
+};
+
+namespace detail {
+class key_index;
+struct struct_path;
+}  // namespace detail
+
 // field metadata struct
 struct field_metadata {
     const char* name;              // field name
@@ -55,848 +170,6606 @@ struct field_metadata {
                           // struct_type_name
     size_t element_size;  // Array element size, valid when type_code is ARRAY
     size_t array_length;  // Array length, valid when type_code is ARRAY
+    // dimensions of a multi-dimensional array, whose element_size / array_length then describe the innermost
+    // elements of the whole contiguous block; extents is only set when rank > 1
+    size_t rank = 1;
+    const size_t* extents = nullptr;
+    // metadata accessor of the nested struct / struct array element type, set by register_json_struct;
+    // the legacy STRUCT_TRANSLATOR_* macros leave it null and are resolved through struct_type_name instead
+    const std::vector<field_metadata>* (*struct_metadata)() = nullptr;
+    // compile-time field table of the nested struct of a struct, fixed array or optional field, set when that type is
+    // registered with register_json_struct; the text writer walks it without publishing anything to the registry
+    const field_metadata* struct_fields = nullptr;
+    size_t struct_field_count = 0;
+    // key index of the nested struct / struct array element type for the text decoders, built once per type; set by
+    // register_json_struct, the accessor returns null while the type is unknown
+    const detail::key_index* (*struct_index)() = nullptr;
+    // compile-time check of the nested struct / struct array element type for std::string_view fields, set by
+    // register_json_struct (see detail::holds_string_views)
+    bool (*struct_views)(const detail::struct_path* path) = nullptr;
+    // container access, valid when type_code is VECTOR
+    const sequence_ops* sequence = nullptr;
+    // optional access, valid when type_code is OPTIONAL; the value is described by sub_type_code / element_size
+    const optional_ops* optional = nullptr;
+    // enum access, valid when type_code is ENUM
+    const enum_ops* enumeration = nullptr;
+    // associative container access, valid when type_code is MAP; values are described by sub_type_code / element_size
+    const map_ops* map = nullptr;
+    // sibling member holding the live length of a fixed array, UNKNOWN when the whole array is live
+    TYPE_CODE count_type_code = TYPE_CODE::UNKNOWN;
+    size_t count_offset = 0;
+    // text encoding of a byte array, ARRAY for everything else
+    BYTES_FORMAT bytes_format = BYTES_FORMAT::ARRAY;
+    // worst-case length of the value as written by to_json_string, 0 when it is unbounded (std::string, containers)
+    size_t max_json_size = 0;
 };
 
-// struct metadata manager class
-class MetadataManager {
-private:
-    // store metadata for all structs
-    inline static std::unordered_map<std::string, std::vector<field_metadata>> metadata_map;
+// fields of a struct as a plain range, either a compile-time table or a metadata vector
+struct field_table {
+    const field_metadata* fields = nullptr;
+    size_t count = 0;
 
-public:
-    // register struct metadata
-    static void register_metadata(const std::string& type_id, const std::vector<field_metadata>& fields) {
-        metadata_map[type_id] = fields;
-    }
+    constexpr field_table() = default;
+    constexpr field_table(const field_metadata* fields, size_t count) : fields(fields), count(count) {}
+    field_table(const std::vector<field_metadata>& metadata) : fields(metadata.data()), count(metadata.size()) {}
 
-    // get struct metadata
-    static const std::vector<field_metadata>* get_metadata(const std::string& type_id) {
-        auto it = metadata_map.find(type_id);
-        if (it != metadata_map.end()) {
-            return &(it->second);
-        }
-        return nullptr;
+    size_t size() const {
+        return count;
+    }
+    const field_metadata& operator[](size_t index) const {
+        return fields[index];
+    }
+    const field_metadata* begin() const {
+        return fields;
+    }
+    const field_metadata* end() const {
+        return fields + count;
     }
 };
 
-// type traits utility - used to determine type characteristics
-template <typename T>
-struct type_traits {
-    static constexpr bool is_array = false;
-    static constexpr bool is_function = false;
-    static constexpr bool is_string = false;
-    static constexpr bool is_char_array = false;
-};
+// optional conversion statistics, compiled in with -DJSTON_ENABLE_STATS
+// counts metadata lookups and per-field conversions, plus heap allocations made while a conversion is running on the
+// calling thread; allocations are only seen when JSTON_STATS_ALLOCATION_HOOK() is expanded in exactly one translation
+// unit of the program (it replaces the global allocation functions)
+namespace stats {
 
-// array type specialization template
-template <typename T, size_t N>
-struct type_traits<T[N]> {
-    static constexpr bool is_array = true;
-    static constexpr bool is_function = false;
-    static constexpr bool is_string = std::is_same<T, char>::value;
-    static constexpr bool is_char_array = std::is_same<T, char>::value;
-    using ELEMENT_TYPE = T;
-    static constexpr size_t size = N;
+// point-in-time copy of the counters
+struct snapshot_data {
+    uint64_t allocations = 0;       // heap allocations during conversions
+    uint64_t allocated_bytes = 0;   // bytes requested by those allocations
+    uint64_t metadata_lookups = 0;  // MetadataManager::get_metadata calls
+    uint64_t fields_encoded = 0;    // fields converted by to_json
+    uint64_t fields_decoded = 0;    // fields converted by from_json / from_json_string
 };
 
-// function pointer type specialization template
-template <typename Ret, typename... Args>
-struct type_traits<Ret (*)(Args...)> {
-    static constexpr bool is_array = false;
-    static constexpr bool is_function = true;
-    static constexpr bool is_string = false;
-    static constexpr bool is_char_array = false;
-    static constexpr TYPE_CODE type_code = TYPE_CODE::FUNCTION;
-};
+#ifdef JSTON_ENABLE_STATS
+constexpr bool enabled = true;
 
-// pointer type specialization template
-template <typename T>
-struct type_traits<T*> {
-    static constexpr bool is_array = false;
-    static constexpr bool is_function = false;
-    static constexpr bool is_string = false;
-    static constexpr bool is_char_array = false;
-    static constexpr TYPE_CODE type_code = TYPE_CODE::POINTER;
-    using POINTER_TYPE = T;
+namespace detail {
+
+struct counters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> allocated_bytes{0};
+    std::atomic<uint64_t> metadata_lookups{0};
+    std::atomic<uint64_t> fields_encoded{0};
+    std::atomic<uint64_t> fields_decoded{0};
 };
 
-// get type code general template function
-template <typename T>
-TYPE_CODE get_type_code() {
-    if (std::is_same<T, char>::value) {
-        return TYPE_CODE::CHAR;
-    }
-    if (std::is_same<T, short>::value) {
-        return TYPE_CODE::SHORT;
-    }
-    if (std::is_same<T, int>::value) {
-        return TYPE_CODE::INT;
-    }
-    if (std::is_same<T, long>::value) {
-        return TYPE_CODE::LONG;
-    }
-    if (std::is_same<T, long long>::value) {
-        return TYPE_CODE::LONG_LONG;
-    }
-    if (std::is_same<T, unsigned short>::value) {
-        return TYPE_CODE::U_SHORT;
+inline counters g_counters;
+inline thread_local int conversion_depth = 0;
+
+// marks the calling thread as running a conversion for the lifetime of the object
+struct conversion_scope {
+    conversion_scope() {
+        ++conversion_depth;
     }
-    if (std::is_same<T, unsigned int>::value) {
-        return TYPE_CODE::U_INT;
+    ~conversion_scope() {
+        --conversion_depth;
     }
-    if (std::is_same<T, unsigned long>::value) {
-        return TYPE_CODE::U_LONG;
+    conversion_scope(const conversion_scope&) = delete;
+    conversion_scope& operator=(const conversion_scope&) = delete;
+};
+
+inline void record_allocation(size_t size) {
+    if (conversion_depth > 0) {
+        g_counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        g_counters.allocated_bytes.fetch_add(size, std::memory_order_relaxed);
     }
-    if (std::is_same<T, unsigned long long>::value) {
-        return TYPE_CODE::U_LONG_LONG;
+}
+
+// the one allocation and deallocation function behind every form of the replaced new and delete, so that all of
+// them agree on malloc and free. both stay out of line: inlined into callers, GCC flags a free of a pointer that came
+// from operator new (-Wmismatched-new-delete) and a malloc of a size it cannot bound (-Walloc-size-larger-than)
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+inline void* allocate(size_t size) noexcept {
+    record_allocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+inline void release(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+}  // namespace detail
+
+// read all counters
+inline snapshot_data snapshot() {
+    snapshot_data data;
+    data.allocations = detail::g_counters.allocations.load(std::memory_order_relaxed);
+    data.allocated_bytes = detail::g_counters.allocated_bytes.load(std::memory_order_relaxed);
+    data.metadata_lookups = detail::g_counters.metadata_lookups.load(std::memory_order_relaxed);
+    data.fields_encoded = detail::g_counters.fields_encoded.load(std::memory_order_relaxed);
+    data.fields_decoded = detail::g_counters.fields_decoded.load(std::memory_order_relaxed);
+    return data;
+}
+
+// reset all counters to zero
+inline void reset() {
+    detail::g_counters.allocations.store(0, std::memory_order_relaxed);
+    detail::g_counters.allocated_bytes.store(0, std::memory_order_relaxed);
+    detail::g_counters.metadata_lookups.store(0, std::memory_order_relaxed);
+    detail::g_counters.fields_encoded.store(0, std::memory_order_relaxed);
+    detail::g_counters.fields_decoded.store(0, std::memory_order_relaxed);
+}
+
+#define JSTON_STATS_COUNT(counter) ::jston::stats::detail::g_counters.counter.fetch_add(1, std::memory_order_relaxed)
+#define JSTON_STATS_SCOPE()        ::jston::stats::detail::conversion_scope jston_stats_scope
+
+// replaces the global allocation functions so allocations made during conversions are counted
+#define JSTON_STATS_ALLOCATION_HOOK()                                                                                  \
+    void* operator new(std::size_t size) {                                                                             \
+        if (void* ptr = ::jston::stats::detail::allocate(size)) {                                                      \
+            return ptr;                                                                                                \
+        }                                                                                                              \
+        throw std::bad_alloc();                                                                                        \
+    }                                                                                                                  \
+    void* operator new[](std::size_t size) {                                                                           \
+        return ::operator new(size);                                                                                   \
+    }                                                                                                                  \
+    void* operator new(std::size_t size, const std::nothrow_t&) noexcept {                                             \
+        return ::jston::stats::detail::allocate(size);                                                                 \
+    }                                                                                                                  \
+    void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {                                           \
+        return ::jston::stats::detail::allocate(size);                                                                 \
+    }                                                                                                                  \
+    void operator delete(void* ptr) noexcept {                                                                         \
+        ::jston::stats::detail::release(ptr);                                                                          \
+    }                                                                                                                  \
+    void operator delete[](void* ptr) noexcept {                                                                       \
+        ::jston::stats::detail::release(ptr);                                                                          \
+    }                                                                                                                  \
+    void operator delete(void* ptr, std::size_t) noexcept {                                                            \
+        ::jston::stats::detail::release(ptr);                                                                          \
+    }                                                                                                                  \
+    void operator delete[](void* ptr, std::size_t) noexcept {                                                          \
+        ::jston::stats::detail::release(ptr);                                                                          \
+    }                                                                                                                  \
+    void operator delete(void* ptr, const std::nothrow_t&) noexcept {                                                  \
+        ::jston::stats::detail::release(ptr);                                                                          \
+    }                                                                                                                  \
+    void operator delete[](void* ptr, const std::nothrow_t&) noexcept {                                                \
+        ::jston::stats::detail::release(ptr);                                                                          \
     }
-    if (std::is_same<T, float>::value) {
-        return TYPE_CODE::FLOAT;
+#else
+constexpr bool enabled = false;
+
+// statistics are compiled out, all counters stay zero
+inline snapshot_data snapshot() {
+    return snapshot_data();
+}
+
+inline void reset() {}
+
+#define JSTON_STATS_COUNT(counter) ((void)0)
+#define JSTON_STATS_SCOPE()        ((void)0)
+#define JSTON_STATS_ALLOCATION_HOOK()
+#endif
+
+}  // namespace stats
+
+// optional per-type conversion metrics, compiled in with -DJSTON_ENABLE_METRICS
+// every registered type gets call / error / byte counters and an HDR-style latency histogram for each direction;
+// samples are recorded into per-thread shards so conversions on different threads never contend, and dump_prometheus()
+// / dump_json() merge all shards for scraping
+namespace metrics {
+
+enum class direction { encode = 0, decode = 1 };
+
+// log-linear latency histogram over nanoseconds: values below 8 get exact buckets, above that every power of two is
+// split into 8 sub-buckets, which bounds the relative error to 12.5% over the whole range like an HDR histogram does
+class latency_histogram {
+public:
+    static constexpr int sub_bucket_bits = 3;
+    static constexpr int max_value_bits = 40;  // values are clamped to ~18 minutes
+    static constexpr size_t bucket_count = (max_value_bits - sub_bucket_bits + 1) << sub_bucket_bits;
+
+    static size_t bucket_index(uint64_t value) {
+        if (value >= (uint64_t(1) << max_value_bits)) {
+            value = (uint64_t(1) << max_value_bits) - 1;
+        }
+        if (value < (uint64_t(1) << sub_bucket_bits)) {
+            return static_cast<size_t>(value);
+        }
+        int msb = 63;
+        while (!((value >> msb) & 1)) {
+            --msb;
+        }
+        const int shift = msb - sub_bucket_bits;
+        return (static_cast<size_t>(shift + 1) << sub_bucket_bits) +
+               static_cast<size_t>((value >> shift) & ((1 << sub_bucket_bits) - 1));
     }
-    if (std::is_same<T, double>::value) {
-        return TYPE_CODE::DOUBLE;
+
+    // smallest value that falls into the bucket
+    static uint64_t bucket_lower_bound(size_t index) {
+        if (index < (size_t(1) << sub_bucket_bits)) {
+            return index;
+        }
+        const size_t shift = (index >> sub_bucket_bits) - 1;
+        const uint64_t mantissa = (index & ((1 << sub_bucket_bits) - 1)) | (uint64_t(1) << sub_bucket_bits);
+        return mantissa << shift;
     }
-    if (std::is_same<T, bool>::value) {
-        return TYPE_CODE::BOOL;
+
+    // first value past the bucket
+    static uint64_t bucket_upper_bound(size_t index) {
+        if (index < (size_t(1) << sub_bucket_bits)) {
+            return index + 1;
+        }
+        return bucket_lower_bound(index) + (uint64_t(1) << ((index >> sub_bucket_bits) - 1));
     }
-    // Only C-style char arrays are recognized as string type
-    if (type_traits<T>::is_char_array) {
-        return TYPE_CODE::STRING;
+
+    void record(uint64_t value) {
+        buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
     }
-    if (type_traits<T>::is_function) {
-        return TYPE_CODE::FUNCTION;
+
+    uint64_t count_at(size_t index) const {
+        return buckets[index].load(std::memory_order_relaxed);
     }
-    if (std::is_pointer<T>::value) {
-        return TYPE_CODE::POINTER;
+
+private:
+    std::atomic<uint64_t> buckets[bucket_count] = {};
+};
+
+// counters of one type in one direction, written by a single thread and read by the dumpers
+struct direction_metrics {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> latency_sum_ns{0};
+    latency_histogram latency;
+};
+
+struct type_metrics {
+    direction_metrics directions[2];
+};
+
+#ifdef JSTON_ENABLE_METRICS
+constexpr bool enabled = true;
+
+namespace detail {
+
+// metrics of all types recorded by one thread
+struct shard {
+    std::mutex lock;  // only contended while a dump is running
+    std::unordered_map<std::string, std::unique_ptr<type_metrics>> types;
+};
+
+// all shards ever created, shards of exited threads are handed to new threads so their counts are kept
+struct shard_registry {
+    std::mutex lock;
+    std::vector<std::unique_ptr<shard>> shards;
+    std::vector<shard*> free_shards;
+
+    shard* acquire() {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!free_shards.empty()) {
+            shard* reused = free_shards.back();
+            free_shards.pop_back();
+            return reused;
+        }
+        shards.emplace_back(new shard());
+        return shards.back().get();
     }
-    if (type_traits<T>::is_array && !type_traits<T>::is_char_array) {
-        return TYPE_CODE::ARRAY;
+
+    void release(shard* s) {
+        std::lock_guard<std::mutex> guard(lock);
+        free_shards.push_back(s);
     }
-    // Default to struct type
-    return TYPE_CODE::STRUCT;
+};
+
+inline shard_registry& registry() {
+    static shard_registry* instance = new shard_registry();  // never destroyed, threads may exit after main
+    return *instance;
 }
 
-// forward declare template function for struct registration
-template <typename T>
-void register_struct_metadata();
+// owns the shard of the calling thread
+struct shard_handle {
+    shard* owned = registry().acquire();
+    ~shard_handle() {
+        registry().release(owned);
+    }
+};
 
-// forward declaration of three-parameter from_json function
-void from_json(const std::vector<field_metadata>& metadata, const nlohmann::json& j, void* obj);
+inline shard& local_shard() {
+    thread_local shard_handle handle;
+    return *handle.owned;
+}
 
-// forward declaration of three-parameter to_json function
-nlohmann::json to_json(const std::vector<field_metadata>& metadata, const void* obj);
+// readable name of a registered type
+template <typename T>
+const std::string& type_label() {
+    static const std::string label = [] {
+        std::string name = typeid(T).name();
+#if defined(__GNUG__) || defined(__clang__)
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+        if (status == 0 && demangled) {
+            name = demangled;
+        }
+        std::free(demangled);
+#endif
+        return name;
+    }();
+    return label;
+}
 
-// helper template function for registering metadata
+// metrics of T in the calling thread's shard, cached per thread so the hot path does no lookup
 template <typename T>
-void register_metadata_helper(const std::vector<field_metadata>& fields) {
-    MetadataManager::register_metadata(typeid(T).name(), fields);
+type_metrics& local_type_metrics() {
+    thread_local type_metrics* cached = nullptr;
+    if (!cached) {
+        shard& s = local_shard();
+        std::lock_guard<std::mutex> guard(s.lock);
+        auto& slot = s.types[type_label<T>()];
+        if (!slot) {
+            slot.reset(new type_metrics());
+        }
+        cached = slot.get();
+    }
+    return *cached;
 }
 
-// automatic registration mechanism - automatically call the registration function at program startup
+inline thread_local int call_depth = 0;
+
+// times one conversion call, nested conversions of the same call are not recorded again
 template <typename T>
-class AutoRegistrar {
+class call_scope {
+private:
+    direction dir;
+    bool outermost;
+    int uncaught;
+    uint64_t bytes = 0;
+    std::chrono::steady_clock::time_point start;
+
 public:
-    AutoRegistrar() {
-        register_struct_metadata<T>();
+    explicit call_scope(direction dir)
+        : dir(dir), outermost(call_depth++ == 0), uncaught(std::uncaught_exceptions()),
+          start(std::chrono::steady_clock::now()) {}
+
+    ~call_scope() {
+        --call_depth;
+        if (!outermost) {
+            return;
+        }
+        const uint64_t elapsed = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        direction_metrics& m = local_type_metrics<T>().directions[static_cast<int>(dir)];
+        m.calls.fetch_add(1, std::memory_order_relaxed);
+        if (std::uncaught_exceptions() > uncaught) {
+            m.errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        m.bytes.fetch_add(bytes, std::memory_order_relaxed);
+        m.latency_sum_ns.fetch_add(elapsed, std::memory_order_relaxed);
+        m.latency.record(elapsed);
+    }
+
+    void set_bytes(size_t n) {
+        bytes = n;
     }
+
+    call_scope(const call_scope&) = delete;
+    call_scope& operator=(const call_scope&) = delete;
 };
 
-// trigger automatic registration template variable
-template <typename T>
-AutoRegistrar<T> g_auto_registrar;
+// metrics of one type and direction merged over all shards
+struct merged_direction {
+    uint64_t calls = 0;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+    uint64_t latency_sum_ns = 0;
+    std::vector<uint64_t> buckets = std::vector<uint64_t>(latency_histogram::bucket_count, 0);
 
-// struct to JSON conversion function
-template <typename T>
-nlohmann::json to_json(const T& obj) {
-    const std::string type_id = typeid(T).name();
-    const auto* metadata = MetadataManager::get_metadata(type_id);
+    // latency below which the given fraction of calls completed, using the upper bound of the bucket
+    uint64_t percentile(double fraction) const {
+        const uint64_t target = static_cast<uint64_t>(fraction * calls + 0.5);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            seen += buckets[i];
+            if (seen >= target && seen > 0) {
+                return latency_histogram::bucket_upper_bound(i);
+            }
+        }
+        return 0;
+    }
+};
 
-    if (!metadata) {
-        throw std::runtime_error("No metadata found for type: " + type_id);
+inline std::map<std::string, std::array<merged_direction, 2>> merge_shards() {
+    std::map<std::string, std::array<merged_direction, 2>> merged;
+    shard_registry& r = registry();
+    std::lock_guard<std::mutex> registry_guard(r.lock);
+    for (const auto& s : r.shards) {
+        std::lock_guard<std::mutex> shard_guard(s->lock);
+        for (const auto& entry : s->types) {
+            for (int d = 0; d < 2; ++d) {
+                const direction_metrics& source = entry.second->directions[d];
+                merged_direction& target = merged[entry.first][d];
+                target.calls += source.calls.load(std::memory_order_relaxed);
+                target.errors += source.errors.load(std::memory_order_relaxed);
+                target.bytes += source.bytes.load(std::memory_order_relaxed);
+                target.latency_sum_ns += source.latency_sum_ns.load(std::memory_order_relaxed);
+                for (size_t i = 0; i < latency_histogram::bucket_count; ++i) {
+                    target.buckets[i] += source.latency.count_at(i);
+                }
+            }
+        }
     }
-    return to_json(*metadata, &obj);
+    return merged;
 }
 
-// JSON to struct conversion function
-template <typename T>
-void from_json(const nlohmann::json& j, T& obj) {
-    // check if JSON is an object type
-    if (!j.is_object()) {
-        throw std::runtime_error("JSON value is not an object, cannot convert to struct");
-    }
+inline const char* direction_name(int d) {
+    return d == static_cast<int>(direction::encode) ? "encode" : "decode";
+}
 
-    // get type ID and metadata
-    const std::string type_id = typeid(T).name();
-    const auto* metadata = MetadataManager::get_metadata(type_id);
+}  // namespace detail
 
-    if (!metadata) {
-        throw std::runtime_error("No metadata found for type: " + type_id);
+// all metrics in the Prometheus text exposition format
+// the latency histogram is exported with power-of-two bucket boundaries between 256ns and ~17s
+inline std::string dump_prometheus() {
+    const auto merged = detail::merge_shards();
+    std::string out;
+    out += "# HELP jston_calls_total Number of conversions per registered type.\n";
+    out += "# TYPE jston_calls_total counter\n";
+    out += "# HELP jston_errors_total Number of conversions that failed with an exception.\n";
+    out += "# TYPE jston_errors_total counter\n";
+    out += "# HELP jston_bytes_total JSON text bytes produced by encoding or consumed by decoding.\n";
+    out += "# TYPE jston_bytes_total counter\n";
+    out += "# HELP jston_latency_seconds Conversion latency.\n";
+    out += "# TYPE jston_latency_seconds histogram\n";
+    char buffer[64];
+    for (const auto& entry : merged) {
+        for (int d = 0; d < 2; ++d) {
+            const detail::merged_direction& m = entry.second[d];
+            if (m.calls == 0) {
+                continue;
+            }
+            const std::string labels =
+                "type=\"" + entry.first + "\",direction=\"" + detail::direction_name(d) + "\"";
+            out += "jston_calls_total{" + labels + "} " + std::to_string(m.calls) + "\n";
+            out += "jston_errors_total{" + labels + "} " + std::to_string(m.errors) + "\n";
+            out += "jston_bytes_total{" + labels + "} " + std::to_string(m.bytes) + "\n";
+            uint64_t cumulative = 0;
+            size_t index = 0;
+            for (int bits = 8; bits <= 34; ++bits) {
+                // buckets below 2^bits ns, the power-of-two boundaries are exact bucket boundaries
+                const size_t end_index = latency_histogram::bucket_index(uint64_t(1) << bits);
+                for (; index < end_index; ++index) {
+                    cumulative += m.buckets[index];
+                }
+                snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(uint64_t(1) << bits) / 1e9);
+                out += "jston_latency_seconds_bucket{" + labels + ",le=\"" + buffer + "\"} " +
+                       std::to_string(cumulative) + "\n";
+            }
+            out += "jston_latency_seconds_bucket{" + labels + ",le=\"+Inf\"} " + std::to_string(m.calls) + "\n";
+            snprintf(buffer, sizeof(buffer), "%.9f", static_cast<double>(m.latency_sum_ns) / 1e9);
+            out += "jston_latency_seconds_sum{" + labels + "} " + buffer + "\n";
+            out += "jston_latency_seconds_count{" + labels + "} " + std::to_string(m.calls) + "\n";
+        }
     }
-    from_json(*metadata, j, &obj);
+    return out;
 }
 
-// struct to JSON string conversion function
-template <typename T>
-std::string to_json_string(const T& obj) {
-    return to_json(obj).dump();
+// all metrics as JSON, with percentiles and the non-empty histogram buckets at full resolution
+inline nlohmann::json dump_json() {
+    const auto merged = detail::merge_shards();
+    nlohmann::json result = nlohmann::json::object();
+    for (const auto& entry : merged) {
+        for (int d = 0; d < 2; ++d) {
+            const detail::merged_direction& m = entry.second[d];
+            if (m.calls == 0) {
+                continue;
+            }
+            nlohmann::json j;
+            j["calls"] = m.calls;
+            j["errors"] = m.errors;
+            j["bytes"] = m.bytes;
+            j["latency_sum_ns"] = m.latency_sum_ns;
+            j["p50_ns"] = m.percentile(0.50);
+            j["p90_ns"] = m.percentile(0.90);
+            j["p99_ns"] = m.percentile(0.99);
+            j["max_ns"] = m.percentile(1.0);
+            nlohmann::json buckets = nlohmann::json::array();
+            for (size_t i = 0; i < m.buckets.size(); ++i) {
+                if (m.buckets[i]) {
+                    buckets.push_back({latency_histogram::bucket_lower_bound(i),
+                                       latency_histogram::bucket_upper_bound(i), m.buckets[i]});
+                }
+            }
+            j["histogram"] = buckets;
+            result[entry.first][detail::direction_name(d)] = j;
+        }
+    }
+    return result;
 }
 
-// JSON string to struct conversion function
-template <typename T>
-void from_json_string(const std::string& j, T& obj) {
-    if (j.empty()) {
-        throw std::runtime_error("empty json string provided");
+#define JSTON_METRICS_SCOPE(TypeName, dir)                                                                             \
+    ::jston::metrics::detail::call_scope<TypeName> jston_metrics_scope(::jston::metrics::direction::dir)
+#define JSTON_METRICS_BYTES(n) jston_metrics_scope.set_bytes(n)
+#else
+constexpr bool enabled = false;
+
+// metrics are compiled out, dumps are empty
+inline std::string dump_prometheus() {
+    return std::string();
+}
+
+inline nlohmann::json dump_json() {
+    return nlohmann::json::object();
+}
+
+#define JSTON_METRICS_SCOPE(TypeName, dir) ((void)0)
+#define JSTON_METRICS_BYTES(n)             ((void)0)
+#endif
+
+}  // namespace metrics
+
+// struct metadata manager class
+// the registry is an insert-only open addressing hash table published through an atomic pointer: lookups are wait-free
+// (one acquire load plus a probe sequence, no lock) and may run concurrently with registration, e.g. from plugins
+// loaded at runtime; writers are serialized by a mutex, and when the table grows the previous table is retained so
+// readers that still hold it stay valid (growth is geometric, so retained tables never exceed the live one in size)
+class MetadataManager {
+private:
+    // one registered type, shared by all table generations
+    struct registry_entry {
+        std::string type_id;
+        std::atomic<const std::vector<field_metadata>*> fields;
+    };
+
+    // one generation of the hash table, never modified except for filling empty slots
+    struct registry_table {
+        size_t mask;
+        std::unique_ptr<std::atomic<registry_entry*>[]> slots;
+        const registry_table* previous;  // retained for readers still using the older generation
+    };
+
+public:
+    // a type registered with register_json_struct, published to the table by the first conversion or name lookup
+    struct pending_type {
+        const char* (*type_id)();
+        const std::vector<field_metadata>* (*publish)();
+        const pending_type* next;
+    };
+
+private:
+    // currently published table, constant initialized so registration during static initialization is safe
+    inline static std::atomic<const registry_table*> current_table{nullptr};
+    // every pending_type linked so far, pushed without a lock and never unlinked
+    inline static std::atomic<const pending_type*> pending_types{nullptr};
+    inline static std::mutex writer_lock;
+    inline static size_t entry_count = 0;
+
+    static registry_table* make_table(size_t capacity, const registry_table* previous) {
+        registry_table* table = new registry_table{capacity - 1, nullptr, previous};
+        table->slots.reset(new std::atomic<registry_entry*>[capacity]);
+        for (size_t i = 0; i < capacity; ++i) {
+            table->slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+        return table;
     }
-    
-    try {
-        from_json(nlohmann::json::parse(j), obj);
-    } catch (const nlohmann::json::exception& e) {
-        throw std::runtime_error(std::string("json parsing error: ") + e.what());
-    } catch (const std::exception& e) {
-        throw std::runtime_error(std::string("from_json exception: ") + e.what());
+
+    static void insert_entry(const registry_table* table, registry_entry* entry) {
+        size_t slot = std::hash<std::string_view>()(entry->type_id) & table->mask;
+        while (table->slots[slot].load(std::memory_order_relaxed)) {
+            slot = (slot + 1) & table->mask;
+        }
+        table->slots[slot].store(entry, std::memory_order_release);
     }
-}
 
-// overloaded to_json function, accepts metadata and object pointer as parameters
-inline nlohmann::json to_json(const std::vector<field_metadata>& metadata, const void* obj) {
-    nlohmann::json result;
+    static registry_entry* find_entry(const registry_table* table, std::string_view type_id) {
+        size_t slot = std::hash<std::string_view>()(type_id) & table->mask;
+        for (;;) {
+            registry_entry* entry = table->slots[slot].load(std::memory_order_acquire);
+            if (!entry || entry->type_id == type_id) {
+                return entry;
+            }
+            slot = (slot + 1) & table->mask;
+        }
+    }
 
-    // iterate through all fields and convert
-    for (const auto& field : metadata) {
-        try {
-            // handle differently based on field type
-            switch (field.type_code) {
-                case TYPE_CODE::CHAR: {
-                    const char& value =
-                        *reinterpret_cast<const char*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    result[field.name] = static_cast<uint8_t>(value);
-                    break;
-                }
-                case TYPE_CODE::SHORT: {
-                    const short& value =
-                        *reinterpret_cast<const short*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    result[field.name] = value;
-                    break;
+public:
+    // register struct metadata, registering a type again replaces its metadata for subsequent lookups
+    // (metadata handed out earlier stays valid)
+    static const std::vector<field_metadata>* register_metadata(const std::string& type_id,
+                                                                 const std::vector<field_metadata>& fields) {
+        const auto* stored = new std::vector<field_metadata>(fields);
+
+        std::lock_guard<std::mutex> guard(writer_lock);
+        const registry_table* table = current_table.load(std::memory_order_relaxed);
+        if (table) {
+            if (registry_entry* existing = find_entry(table, type_id)) {
+                existing->fields.store(stored, std::memory_order_release);
+                return stored;
+            }
+        }
+
+        // keep the load factor below one half, growing publishes a new generation
+        if (!table || (entry_count + 1) * 2 > table->mask + 1) {
+            registry_table* grown = make_table(table ? (table->mask + 1) * 2 : 64, table);
+            if (table) {
+                for (size_t i = 0; i <= table->mask; ++i) {
+                    if (registry_entry* entry = table->slots[i].load(std::memory_order_relaxed)) {
+                        insert_entry(grown, entry);
+                    }
                 }
-                case TYPE_CODE::INT: {
-                    const int& value = *reinterpret_cast<const int*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    result[field.name] = value;
-                    break;
+            }
+            current_table.store(grown, std::memory_order_release);
+            table = grown;
+        }
+
+        registry_entry* entry = new registry_entry{type_id, {stored}};
+        insert_entry(table, entry);
+        ++entry_count;
+        return stored;
+    }
+
+    // link a type registered with register_json_struct, so that a lookup by name can publish it before its first
+    // conversion; returns true so that it can initialize a static flag
+    static bool add_pending(pending_type& type) {
+        type.next = pending_types.load(std::memory_order_relaxed);
+        while (!pending_types.compare_exchange_weak(type.next, &type, std::memory_order_release,
+                                                    std::memory_order_relaxed)) {
+        }
+        return true;
+    }
+
+    // get struct metadata, a type registered with register_json_struct that has not been converted yet is published
+    // by the lookup; never blocks unless it publishes
+    static const std::vector<field_metadata>* get_metadata(std::string_view type_id) {
+        JSTON_STATS_COUNT(metadata_lookups);
+        if (const registry_table* table = current_table.load(std::memory_order_acquire)) {
+            if (registry_entry* entry = find_entry(table, type_id)) {
+                return entry->fields.load(std::memory_order_acquire);
+            }
+        }
+        for (const pending_type* type = pending_types.load(std::memory_order_acquire); type; type = type->next) {
+            if (type_id == type->type_id()) {
+                return type->publish();
+            }
+        }
+        return nullptr;
+    }
+};
+
+// compile-time field table of a struct, specialized by register_json_struct
+// the table is a constexpr array, so it is constant-initialized and usable before any dynamic initializer has run
+template <typename T>
+struct struct_info {
+    static constexpr bool is_registered = false;
+};
+
+// compile-time enumerator table of an enum, specialized by register_json_enum
+template <typename E>
+struct enum_info {
+    static constexpr bool is_registered = false;
+    static constexpr bool as_name = false;
+};
+
+// metadata of a struct type
+// types registered with register_json_struct are published to the name registry on first use (a function local
+// static, initialized exactly once even under concurrent first calls); other types fall back to a name lookup
+template <typename T>
+const std::vector<field_metadata>* metadata_of() {
+    if constexpr (struct_info<T>::is_registered) {
+        static const std::vector<field_metadata>* const stored = MetadataManager::register_metadata(
+            typeid(T).name(),
+            std::vector<field_metadata>(std::begin(struct_info<T>::fields), std::end(struct_info<T>::fields)));
+        return stored;
+    } else {
+        return MetadataManager::get_metadata(typeid(T).name());
+    }
+}
+
+// metadata of a struct type, throws if the type has not been registered
+template <typename T>
+const std::vector<field_metadata>& require_metadata() {
+    const auto* metadata = metadata_of<T>();
+    if (!metadata) {
+        throw std::runtime_error(std::string("No metadata found for type: ") + typeid(T).name());
+    }
+    return *metadata;
+}
+
+// fields of a struct type as walked by the conversions: the compile-time table of a type registered with
+// register_json_struct, so that converting it never goes through the registry, else its registered metadata vector;
+// throws if the type has not been registered
+template <typename T>
+field_table fields_of() {
+    if constexpr (struct_info<T>::is_registered) {
+        return field_table(struct_info<T>::fields, std::size(struct_info<T>::fields));
+    } else {
+        return require_metadata<T>();
+    }
+}
+
+// check if a STRUCT / ARRAY field refers to a struct type
+inline bool has_struct_type(const field_metadata& field) {
+    return field.struct_metadata || (field.struct_type_name && *field.struct_type_name);
+}
+
+// metadata of the nested struct / struct array element type of a field, or null
+inline const std::vector<field_metadata>* nested_metadata(const field_metadata& field) {
+    if (field.struct_metadata) {
+        return field.struct_metadata();
+    }
+    if (field.struct_type_name && *field.struct_type_name) {
+        return MetadataManager::get_metadata(field.struct_type_name);
+    }
+    return nullptr;
+}
+
+// fields of the nested struct / struct array element type of a field, taken from the compile-time table when there is
+// one; fields is null when the type is unknown
+inline field_table nested_table(const field_metadata& field) {
+    if (field.struct_fields) {
+        return field_table(field.struct_fields, field.struct_field_count);
+    }
+    const std::vector<field_metadata>* metadata = nested_metadata(field);
+    return metadata ? field_table(*metadata) : field_table();
+}
+
+// field projection mask - selects a subset of fields (and nested subtrees) of a registered struct
+// a mask is compiled once from dotted paths such as "id", "name" or "car.brand"; each level keeps a bitset of the
+// selected field indices plus an optional child mask for partially selected nested structs / struct arrays
+class field_mask {
+private:
+    std::vector<uint64_t> bits;                         // one bit per field index of this level
+    std::vector<std::unique_ptr<field_mask>> children;  // null means "whole subtree" for a selected field
+    size_t selected = 0;                                // number of selected fields at this level
+
+    explicit field_mask(size_t field_count) : bits((field_count + 63) / 64, 0), children(field_count) {}
+
+    void select(size_t index) {
+        if (!selects(index)) {
+            bits[index / 64] |= uint64_t(1) << (index % 64);
+            ++selected;
+        }
+    }
+
+    void add_path(const std::vector<field_metadata>& metadata, std::string_view path) {
+        const size_t dot = path.find('.');
+        const std::string_view segment = path.substr(0, dot);
+        if (segment.empty()) {
+            throw std::runtime_error("Empty segment in field mask path");
+        }
+
+        size_t index = 0;
+        while (index < metadata.size() && segment != metadata[index].name) {
+            ++index;
+        }
+        if (index == metadata.size()) {
+            throw std::runtime_error("Unknown field in field mask: " + std::string(segment));
+        }
+
+        if (dot == std::string_view::npos) {
+            // the whole field (and its subtree) is selected
+            select(index);
+            children[index].reset();
+            return;
+        }
+        if (selects(index) && !children[index]) {
+            return;  // already selected as a whole subtree
+        }
+
+        const field_metadata& field = metadata[index];
+        const std::vector<field_metadata>* nested = nullptr;
+        if (field.type_code == TYPE_CODE::STRUCT || field.type_code == TYPE_CODE::ARRAY ||
+            field.type_code == TYPE_CODE::VECTOR || field.type_code == TYPE_CODE::OPTIONAL ||
+            field.type_code == TYPE_CODE::MAP) {
+            nested = nested_metadata(field);
+        }
+        if (!nested) {
+            throw std::runtime_error("Field is not a registered struct in field mask: " + std::string(segment));
+        }
+
+        select(index);
+        if (!children[index]) {
+            children[index].reset(new field_mask(nested->size()));
+        }
+        children[index]->add_path(*nested, path.substr(dot + 1));
+    }
+
+public:
+    // compile a mask from dotted field paths against struct metadata
+    static field_mask compile(const std::vector<field_metadata>& metadata, const std::vector<std::string>& paths) {
+        field_mask mask(metadata.size());
+        for (const auto& path : paths) {
+            mask.add_path(metadata, path);
+        }
+        return mask;
+    }
+
+    // check if the field at the given metadata index is selected
+    bool selects(size_t index) const {
+        return index < children.size() && (bits[index / 64] >> (index % 64)) & 1;
+    }
+
+    // child mask for a selected nested field, nullptr when the whole subtree is selected
+    const field_mask* child(size_t index) const {
+        return index < children.size() ? children[index].get() : nullptr;
+    }
+
+    // number of selected fields at this level
+    size_t selected_count() const {
+        return selected;
+    }
+};
+
+// type traits utility - used to determine type characteristics
+template <typename T>
+struct type_traits {
+    static constexpr bool is_array = false;
+    static constexpr bool is_function = false;
+    static constexpr bool is_string = false;
+    static constexpr bool is_char_array = false;
+};
+
+// array type specialization template
+template <typename T, size_t N>
+struct type_traits<T[N]> {
+    static constexpr bool is_array = true;
+    static constexpr bool is_function = false;
+    static constexpr bool is_string = std::is_same<T, char>::value;
+    static constexpr bool is_char_array = std::is_same<T, char>::value;
+    using ELEMENT_TYPE = T;
+    static constexpr size_t size = N;
+};
+
+// function pointer type specialization template
+template <typename Ret, typename... Args>
+struct type_traits<Ret (*)(Args...)> {
+    static constexpr bool is_array = false;
+    static constexpr bool is_function = true;
+    static constexpr bool is_string = false;
+    static constexpr bool is_char_array = false;
+    static constexpr TYPE_CODE type_code = TYPE_CODE::FUNCTION;
+};
+
+// pointer type specialization template
+template <typename T>
+struct type_traits<T*> {
+    static constexpr bool is_array = false;
+    static constexpr bool is_function = false;
+    static constexpr bool is_string = false;
+    static constexpr bool is_char_array = false;
+    static constexpr TYPE_CODE type_code = TYPE_CODE::POINTER;
+    using POINTER_TYPE = T;
+};
+
+// std::vector detection
+template <typename T>
+struct is_std_vector : std::false_type {};
+
+template <typename T, typename Alloc>
+struct is_std_vector<std::vector<T, Alloc>> : std::true_type {};
+
+// associative containers keyed by std::string: std::map, std::unordered_map and flat maps, i.e. std::vector of
+// (key, value) pairs kept sorted by key
+template <typename T>
+struct is_string_map : std::false_type {};
+
+template <typename V, typename Compare, typename Alloc>
+struct is_string_map<std::map<std::string, V, Compare, Alloc>> : std::true_type {
+    static constexpr bool is_flat = false;
+    static constexpr bool can_reserve = false;
+};
+
+template <typename V, typename Hash, typename Equal, typename Alloc>
+struct is_string_map<std::unordered_map<std::string, V, Hash, Equal, Alloc>> : std::true_type {
+    static constexpr bool is_flat = false;
+    static constexpr bool can_reserve = true;
+};
+
+template <typename V, typename Alloc>
+struct is_string_map<std::vector<std::pair<std::string, V>, Alloc>> : std::true_type {
+    static constexpr bool is_flat = true;
+    static constexpr bool can_reserve = true;
+};
+
+// extents of every dimension of an array type
+template <typename T, typename = std::make_index_sequence<std::rank<T>::value>>
+struct array_extents;
+
+template <typename T, size_t... I>
+struct array_extents<T, std::index_sequence<I...>> {
+    static constexpr size_t values[] = {std::extent<T, I>::value...};
+};
+
+// std::optional detection
+template <typename T>
+struct is_std_optional : std::false_type {};
+
+template <typename T>
+struct is_std_optional<std::optional<T>> : std::true_type {};
+
+// sequence_ops implementation for one std::vector type
+template <typename V>
+struct sequence_ops_of {
+    using ELEMENT_TYPE = typename V::value_type;
+    static constexpr bool is_bool = std::is_same<ELEMENT_TYPE, bool>::value;
+
+    static size_t size(const void* sequence) {
+        return static_cast<const V*>(sequence)->size();
+    }
+    static void resize(void* sequence, size_t size) {
+        static_cast<V*>(sequence)->resize(size);
+    }
+    static const void* data(const void* sequence) {
+        if constexpr (is_bool) {
+            return nullptr;
+        } else {
+            return static_cast<const V*>(sequence)->data();
+        }
+    }
+    static void* mutable_data(void* sequence) {
+        if constexpr (is_bool) {
+            return nullptr;
+        } else {
+            return static_cast<V*>(sequence)->data();
+        }
+    }
+    static bool get_bool(const void* sequence, size_t index) {
+        if constexpr (is_bool) {
+            return (*static_cast<const V*>(sequence))[index];
+        } else {
+            return false;
+        }
+    }
+    static void set_bool(void* sequence, size_t index, bool value) {
+        if constexpr (is_bool) {
+            (*static_cast<V*>(sequence))[index] = value;
+        }
+    }
+
+    static constexpr sequence_ops ops = {&size, &resize, &data, &mutable_data, &get_bool, &set_bool};
+};
+
+namespace detail {
+
+// seeded FNV-1a over an enumerator name, used by the compile-time name index
+constexpr uint64_t enum_name_hash(std::string_view name, uint64_t seed) {
+    uint64_t hash = 14695981039346656037ull ^ (seed * 0x9E3779B97F4A7C15ull);
+    for (size_t i = 0; i < name.size(); ++i) {
+        hash ^= static_cast<unsigned char>(name[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash ^ (hash >> 32);
+}
+
+// smallest power of two not below n
+constexpr size_t enum_index_slots(size_t n) {
+    size_t slots = 1;
+    while (slots < n) {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+// perfect hash from enumerator name to entry index, built at compile time by hash and displace: a first hash picks a
+// bucket, and the seed stored for that bucket sends each of its names to a slot no other name occupies, so a lookup
+// costs two hashes and a single name comparison
+template <size_t N>
+struct enum_name_index {
+    static constexpr size_t buckets = N > 0 ? N : 1;
+    static constexpr size_t slots = enum_index_slots(buckets);
+
+    uint32_t seeds[buckets] = {};
+    uint16_t slot_entry[slots] = {};  // entry index + 1, 0 for a free slot
+    bool complete = false;
+
+    static constexpr enum_name_index build(const enum_entry* entries) {
+        enum_name_index index{};
+        size_t bucket_of[buckets] = {};
+        size_t bucket_size[buckets] = {};
+        for (size_t i = 0; i < N; ++i) {
+            bucket_of[i] = enum_name_hash(entries[i].name, 0) % buckets;
+            ++bucket_size[bucket_of[i]];
+        }
+
+        // place the largest buckets first, while most slots are still free
+        bool placed[buckets] = {};
+        for (;;) {
+            size_t bucket = buckets;
+            for (size_t b = 0; b < buckets; ++b) {
+                if (!placed[b] && bucket_size[b] > 0 && (bucket == buckets || bucket_size[b] > bucket_size[bucket])) {
+                    bucket = b;
                 }
-                case TYPE_CODE::LONG: {
-                    const long& value =
-                        *reinterpret_cast<const long*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    result[field.name] = value;
-                    break;
+            }
+            if (bucket == buckets) {
+                break;
+            }
+
+            uint32_t seed = 1;
+            for (; seed < (1u << 20); ++seed) {
+                size_t taken[buckets] = {};
+                size_t taken_count = 0;
+                bool fits = true;
+                for (size_t i = 0; i < N && fits; ++i) {
+                    if (bucket_of[i] != bucket) {
+                        continue;
+                    }
+                    const size_t slot = enum_name_hash(entries[i].name, seed) & (slots - 1);
+                    fits = index.slot_entry[slot] == 0;
+                    for (size_t t = 0; t < taken_count && fits; ++t) {
+                        fits = taken[t] != slot;
+                    }
+                    taken[taken_count++] = slot;
                 }
-                case TYPE_CODE::LONG_LONG: {
-                    const long long& value =
-                        *reinterpret_cast<const long long*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    result[field.name] = value;
+                if (fits) {
                     break;
                 }
-                case TYPE_CODE::U_SHORT: {
-                    const unsigned short& value =
-                        *reinterpret_cast<const unsigned short*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    result[field.name] = value;
-                    break;
+            }
+            if (seed == (1u << 20)) {
+                return index;
+            }
+            for (size_t i = 0; i < N; ++i) {
+                if (bucket_of[i] == bucket) {
+                    const size_t slot = enum_name_hash(entries[i].name, seed) & (slots - 1);
+                    index.slot_entry[slot] = static_cast<uint16_t>(i + 1);
                 }
-                case TYPE_CODE::U_INT: {
-                    const unsigned int& value =
-                        *reinterpret_cast<const unsigned int*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    result[field.name] = value;
-                    break;
+            }
+            index.seeds[bucket] = seed;
+            placed[bucket] = true;
+        }
+        index.complete = true;
+        return index;
+    }
+
+    // entry index of a name, -1 when it is not an enumerator
+    constexpr int find(const enum_entry* entries, std::string_view name) const {
+        const uint32_t seed = seeds[enum_name_hash(name, 0) % buckets];
+        const uint16_t entry = slot_entry[enum_name_hash(name, seed) & (slots - 1)];
+        return entry != 0 && name == entries[entry - 1].name ? entry - 1 : -1;
+    }
+};
+
+// registered enumerators of an enum, none for unregistered enums
+template <typename E, bool = enum_info<E>::is_registered>
+struct enum_entries {
+    static constexpr size_t count = 0;
+    static constexpr const enum_entry* entries = nullptr;
+};
+
+template <typename E>
+struct enum_entries<E, true> {
+    static constexpr size_t count = sizeof(enum_info<E>::entries) / sizeof(enum_entry);
+    static constexpr const enum_entry* entries = enum_info<E>::entries;
+};
+
+}  // namespace detail
+
+// map_ops implementation for one associative container type
+template <typename M>
+struct map_ops_of {
+    static constexpr bool is_flat = is_string_map<M>::is_flat;
+    static constexpr bool can_reserve = is_string_map<M>::can_reserve;
+
+    static size_t size(const void* map) {
+        return static_cast<const M*>(map)->size();
+    }
+    static void clear(void* map) {
+        static_cast<M*>(map)->clear();
+    }
+    static void reserve(void* map, size_t count) {
+        if constexpr (can_reserve) {
+            static_cast<M*>(map)->reserve(count);  // buckets of std::unordered_map, capacity of flat maps
+        }
+    }
+    static void for_each(const void* map, map_ops::visitor visit, void* context) {
+        for (const auto& entry : *static_cast<const M*>(map)) {
+            visit(context, entry.first, &entry.second);
+        }
+    }
+    using iterator = typename M::const_iterator;
+    static constexpr bool has_cursor = sizeof(iterator) <= sizeof(map_cursor::storage) &&
+                                       alignof(iterator) <= alignof(map_cursor) &&
+                                       std::is_trivially_destructible<iterator>::value;
+    static void first(const void* map, map_cursor& cursor) {
+        new (cursor.storage) iterator(static_cast<const M*>(map)->begin());
+    }
+    static bool next(const void* map, map_cursor& cursor, std::string_view& key, const void*& value) {
+        iterator& it = *std::launder(reinterpret_cast<iterator*>(cursor.storage));
+        if (it == static_cast<const M*>(map)->end()) {
+            return false;
+        }
+        key = it->first;
+        value = &it->second;
+        ++it;
+        return true;
+    }
+    static void* emplace(void* map, std::string_view key) {
+        M& m = *static_cast<M*>(map);
+        if constexpr (is_flat) {
+            // appended as they come, finish() sorts once at the end
+            m.emplace_back(std::string(key), typename M::value_type::second_type());
+            return &m.back().second;
+        } else {
+            return &m.try_emplace(std::string(key)).first->second;
+        }
+    }
+    static void finish(void* map) {
+        if constexpr (is_flat) {
+            // sort by key and keep the last of duplicate keys, as assigning them to a map would
+            M& m = *static_cast<M*>(map);
+            std::stable_sort(m.begin(), m.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            auto out = m.begin();
+            for (auto it = m.begin(); it != m.end(); ++it) {
+                if (out != m.begin() && (out - 1)->first == it->first) {
+                    *(out - 1) = std::move(*it);
+                } else {
+                    if (out != it) {
+                        *out = std::move(*it);
+                    }
+                    ++out;
                 }
-                case TYPE_CODE::U_LONG: {
-                    const unsigned long& value =
-                        *reinterpret_cast<const unsigned long*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    result[field.name] = value;
-                    break;
+            }
+            m.erase(out, m.end());
+        }
+    }
+
+    static constexpr map_ops ops = {&size,
+                                    &clear,
+                                    can_reserve ? &reserve : nullptr,
+                                    &for_each,
+                                    has_cursor ? &first : nullptr,
+                                    has_cursor ? &next : nullptr,
+                                    &emplace,
+                                    &finish};
+};
+
+// enum_ops implementation for one enum type
+template <typename E>
+struct enum_ops_of {
+    using entries_of = detail::enum_entries<E>;
+    static constexpr size_t count = entries_of::count;
+    static constexpr detail::enum_name_index<count> index = detail::enum_name_index<count>::build(entries_of::entries);
+    static_assert(index.complete, "no perfect hash found for the enumerator names");
+
+    // true when the enumerators are registered in value order without gaps, the common case, so names are indexed
+    static constexpr bool is_sequential() {
+        for (size_t i = 1; i < count; ++i) {
+            if (entries_of::entries[i].value != entries_of::entries[0].value + static_cast<long long>(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static long long get(const void* value) {
+        return static_cast<long long>(*static_cast<const E*>(value));
+    }
+    static void set(void* value, long long raw) {
+        *static_cast<E*>(value) = static_cast<E>(raw);
+    }
+    static bool in_range(long long raw) {
+        using underlying = std::underlying_type_t<E>;
+        if constexpr (std::is_signed<underlying>::value) {
+            return raw >= static_cast<long long>(std::numeric_limits<underlying>::min()) &&
+                   raw <= static_cast<long long>(std::numeric_limits<underlying>::max());
+        } else {
+            return raw >= 0 && static_cast<unsigned long long>(raw) <= std::numeric_limits<underlying>::max();
+        }
+    }
+    static const char* name_of(long long raw) {
+        if constexpr (count > 0 && is_sequential()) {
+            const long long offset = raw - entries_of::entries[0].value;
+            return offset >= 0 && offset < static_cast<long long>(count) ? entries_of::entries[offset].name : nullptr;
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                if (entries_of::entries[i].value == raw) {
+                    return entries_of::entries[i].name;
                 }
-                case TYPE_CODE::U_LONG_LONG: {
-                    const unsigned long long& value =
-                        *reinterpret_cast<const unsigned long long*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    result[field.name] = value;
+            }
+            return nullptr;
+        }
+    }
+    static bool value_of(std::string_view name, long long& raw) {
+        const int found = count > 0 ? index.find(entries_of::entries, name) : -1;
+        if (found < 0) {
+            return false;
+        }
+        raw = entries_of::entries[found].value;
+        return true;
+    }
+
+    static constexpr enum_ops ops = {&get, &set, &in_range, &name_of, &value_of, enum_info<E>::as_name};
+};
+
+// optional_ops implementation for one std::optional type
+template <typename O>
+struct optional_ops_of {
+    static bool has_value(const void* optional) {
+        return static_cast<const O*>(optional)->has_value();
+    }
+    static const void* value(const void* optional) {
+        const O& o = *static_cast<const O*>(optional);
+        return o ? &*o : nullptr;
+    }
+    static void* emplace(void* optional) {
+        O& o = *static_cast<O*>(optional);
+        if (!o) {
+            o.emplace();
+        }
+        return &*o;
+    }
+    static void reset(void* optional) {
+        static_cast<O*>(optional)->reset();
+    }
+
+    static constexpr optional_ops ops = {&has_value, &value, &emplace, &reset};
+};
+
+// get type code general template function
+template <typename T>
+constexpr TYPE_CODE get_type_code() {
+    if (std::is_same<T, char>::value) {
+        return TYPE_CODE::CHAR;
+    }
+    if (std::is_same<T, signed char>::value) {
+        return TYPE_CODE::S_CHAR;
+    }
+    if (std::is_same<T, unsigned char>::value) {
+        return TYPE_CODE::U_CHAR;
+    }
+    if (std::is_same<T, short>::value) {
+        return TYPE_CODE::SHORT;
+    }
+    if (std::is_same<T, int>::value) {
+        return TYPE_CODE::INT;
+    }
+    if (std::is_same<T, long>::value) {
+        return TYPE_CODE::LONG;
+    }
+    if (std::is_same<T, long long>::value) {
+        return TYPE_CODE::LONG_LONG;
+    }
+    if (std::is_same<T, unsigned short>::value) {
+        return TYPE_CODE::U_SHORT;
+    }
+    if (std::is_same<T, unsigned int>::value) {
+        return TYPE_CODE::U_INT;
+    }
+    if (std::is_same<T, unsigned long>::value) {
+        return TYPE_CODE::U_LONG;
+    }
+    if (std::is_same<T, unsigned long long>::value) {
+        return TYPE_CODE::U_LONG_LONG;
+    }
+    if (std::is_same<T, float>::value) {
+        return TYPE_CODE::FLOAT;
+    }
+    if (std::is_same<T, double>::value) {
+        return TYPE_CODE::DOUBLE;
+    }
+    if (std::is_same<T, bool>::value) {
+        return TYPE_CODE::BOOL;
+    }
+    if (std::is_same<T, std::string>::value) {
+        return TYPE_CODE::STD_STRING;
+    }
+    if (std::is_same<T, std::string_view>::value) {
+        return TYPE_CODE::STRING_VIEW;
+    }
+    if (is_string_map<T>::value) {
+        return TYPE_CODE::MAP;
+    }
+    if (is_std_vector<T>::value) {
+        return TYPE_CODE::VECTOR;
+    }
+    if (is_std_optional<T>::value) {
+        return TYPE_CODE::OPTIONAL;
+    }
+    if (std::is_enum<T>::value) {
+        return TYPE_CODE::ENUM;
+    }
+    // Only C-style char arrays are recognized as string type
+    if (type_traits<T>::is_char_array) {
+        return TYPE_CODE::STRING;
+    }
+    if (type_traits<T>::is_function) {
+        return TYPE_CODE::FUNCTION;
+    }
+    if (std::is_pointer<T>::value) {
+        return TYPE_CODE::POINTER;
+    }
+    if (type_traits<T>::is_array && !type_traits<T>::is_char_array) {
+        return TYPE_CODE::ARRAY;
+    }
+    // Default to struct type
+    return TYPE_CODE::STRUCT;
+}
+
+// forward declaration of three-parameter from_json function, metadata is a compile-time table or a metadata vector
+void from_json(field_table metadata, const nlohmann::json& j, void* obj);
+
+// forward declaration of three-parameter to_json function, metadata is a compile-time table or a metadata vector
+nlohmann::json to_json(field_table metadata, const void* obj, const field_mask* mask = nullptr);
+
+// element type code of basic type arrays, UNKNOWN for struct and other element types
+template <typename T>
+constexpr TYPE_CODE array_sub_type_code() {
+    if (std::is_same<T, int>::value) {
+        return TYPE_CODE::INT;
+    }
+    if (std::is_same<T, double>::value) {
+        return TYPE_CODE::DOUBLE;
+    }
+    if (std::is_same<T, float>::value) {
+        return TYPE_CODE::FLOAT;
+    }
+    if (std::is_same<T, long>::value) {
+        return TYPE_CODE::LONG;
+    }
+    if (std::is_same<T, long long>::value) {
+        return TYPE_CODE::LONG_LONG;
+    }
+    if (std::is_same<T, short>::value) {
+        return TYPE_CODE::SHORT;
+    }
+    if (std::is_same<T, unsigned int>::value) {
+        return TYPE_CODE::U_INT;
+    }
+    if (std::is_same<T, unsigned short>::value) {
+        return TYPE_CODE::U_SHORT;
+    }
+    if (std::is_same<T, unsigned long>::value) {
+        return TYPE_CODE::U_LONG;
+    }
+    if (std::is_same<T, unsigned long long>::value) {
+        return TYPE_CODE::U_LONG_LONG;
+    }
+    if (std::is_same<T, signed char>::value) {
+        return TYPE_CODE::S_CHAR;
+    }
+    if (std::is_same<T, unsigned char>::value) {
+        return TYPE_CODE::U_CHAR;
+    }
+    if (std::is_same<T, bool>::value) {
+        return TYPE_CODE::BOOL;
+    }
+    return TYPE_CODE::UNKNOWN;
+}
+
+namespace detail {
+
+// longest text of an integer type: all decimal digits plus the sign
+template <typename V>
+constexpr size_t max_integer_size() {
+    return std::numeric_limits<V>::digits10 + 1 + (std::is_signed<V>::value ? 1 : 0);
+}
+
+// worst-case text length of a basic value as written by to_json_string, 0 for types without a bound
+// floating point values take the shortest round-trip form, and an integral value written in fixed notation (only
+// chosen when it is not longer than the exponent form) gains ".0"; the longest such texts are "-1000000061440.0" for
+// float (found by trying every value) and e.g. "-1018823507392274104320.0" for double
+constexpr size_t max_basic_size(TYPE_CODE type_code) {
+    switch (type_code) {
+        case TYPE_CODE::CHAR:
+        case TYPE_CODE::U_CHAR:
+            return max_integer_size<unsigned char>();
+        case TYPE_CODE::S_CHAR:
+            return max_integer_size<signed char>();
+        case TYPE_CODE::SHORT:
+            return max_integer_size<short>();
+        case TYPE_CODE::INT:
+            return max_integer_size<int>();
+        case TYPE_CODE::LONG:
+            return max_integer_size<long>();
+        case TYPE_CODE::LONG_LONG:
+            return max_integer_size<long long>();
+        case TYPE_CODE::U_SHORT:
+            return max_integer_size<unsigned short>();
+        case TYPE_CODE::U_INT:
+            return max_integer_size<unsigned int>();
+        case TYPE_CODE::U_LONG:
+            return max_integer_size<unsigned long>();
+        case TYPE_CODE::U_LONG_LONG:
+            return max_integer_size<unsigned long long>();
+        case TYPE_CODE::FLOAT:
+            return 16;
+        case TYPE_CODE::DOUBLE:
+            return 25;
+        case TYPE_CODE::BOOL:
+            return 5;
+        case TYPE_CODE::FUNCTION:
+            return sizeof("\"[function_pointer]\"") - 1;
+        case TYPE_CODE::POINTER:
+            return sizeof("\"[pointer]\"") - 1;
+        default:
+            return 0;
+    }
+}
+
+// worst-case text length of a JSON array of count values of at most element_size characters each
+constexpr size_t max_array_size(size_t count, size_t element_size) {
+    if (element_size == 0) {
+        return 0;
+    }
+    return 2 + count * element_size + (count > 0 ? count - 1 : 0);
+}
+
+// worst-case text length of a char array of capacity characters: every character may need a \u00XX escape
+constexpr size_t max_string_size(size_t capacity) {
+    return 2 + 6 * capacity;
+}
+
+constexpr size_t max_bytes_size(BYTES_FORMAT format, size_t count) {
+    return 2 + (format == BYTES_FORMAT::HEX ? 2 * count : (count + 2) / 3 * 4);
+}
+
+constexpr size_t name_length(const char* name) {
+    size_t length = 0;
+    while (name[length] != '\0') {
+        ++length;
+    }
+    return length;
+}
+
+// worst-case text length of a registered struct, 0 when any of its fields is unbounded or the type is not registered
+// through register_json_struct
+template <typename T>
+constexpr size_t max_struct_size() {
+    if constexpr (struct_info<T>::is_registered) {
+        size_t total = 2;
+        size_t index = 0;
+        for (const field_metadata& field : struct_info<T>::fields) {
+            if (field.max_json_size == 0) {
+                return 0;
+            }
+            total += (index++ > 0 ? 1 : 0) + name_length(field.name) + 3 + field.max_json_size;
+        }
+        return total;
+    } else {
+        return 0;
+    }
+}
+
+// worst-case text length of a value of type V held by an array, optional or nested struct field
+template <typename V>
+constexpr size_t max_value_size() {
+    if constexpr (get_type_code<V>() == TYPE_CODE::STRUCT) {
+        return max_struct_size<V>();
+    } else {
+        return max_basic_size(get_type_code<V>());
+    }
+}
+
+// worst-case text length of an enum, its longest registered name when names are emitted, else its underlying integer
+template <typename E>
+constexpr size_t max_enum_size() {
+    size_t size = max_integer_size<std::underlying_type_t<E>>();
+    if constexpr (enum_info<E>::as_name) {
+        for (size_t i = 0; i < enum_entries<E>::count; ++i) {
+            const size_t length = 2 + name_length(enum_entries<E>::entries[i].name);
+            size = length > size ? length : size;
+        }
+    }
+    return size;
+}
+
+// key index of a struct type, null while the type is unknown
+template <typename T>
+const key_index* find_key_index();
+
+// registered structs that enclose the one being checked by holds_string_views
+struct struct_path {
+    const field_metadata* fields;
+    const struct_path* parent;
+};
+
+// true if a struct registered with register_json_struct, or a struct nested in it at any depth (also as the element
+// of an array, vector, map or optional), has a std::string_view field. a struct already on the path is not entered
+// again, which stops at structs that contain themselves through a vector or map
+template <typename T>
+constexpr bool holds_string_views(const struct_path* path = nullptr) {
+    if constexpr (struct_info<T>::is_registered) {
+        for (const struct_path* outer = path; outer; outer = outer->parent) {
+            if (outer->fields == struct_info<T>::fields) {
+                return false;
+            }
+        }
+        const struct_path here{struct_info<T>::fields, path};
+        for (const field_metadata& field : struct_info<T>::fields) {
+            if (field.type_code == TYPE_CODE::STRING_VIEW || (field.struct_views && field.struct_views(&here))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// resolve the nested struct type S of a struct, fixed array or optional field to its compile-time table
+// the table has to exist when the containing struct is registered: struct_info<S> is instantiated here, and a
+// register_json_struct(S) further down would then be a specialization after instantiation. vector and map fields
+// only take the address of metadata_of<S>, which is resolved at the end of the translation unit, so their element
+// type may be registered later (or be the containing struct itself)
+template <typename S>
+constexpr void bind_struct_type(field_metadata& field) {
+    static_assert(struct_info<S>::is_registered,
+                  "register_json_struct: a nested struct (or the element of a fixed array or std::optional field) "
+                  "must be registered before the struct that contains it");
+    field.struct_metadata = &metadata_of<S>;
+    field.struct_index = &find_key_index<S>;
+    field.struct_views = &holds_string_views<S>;
+    if constexpr (struct_info<S>::is_registered) {
+        field.struct_fields = struct_info<S>::fields;
+        field.struct_field_count = std::size(struct_info<S>::fields);
+    }
+}
+
+}  // namespace detail
+
+// build the metadata of one registered field at compile time
+template <typename Member>
+constexpr field_metadata make_field_metadata(const char* name, size_t offset) {
+    field_metadata field{};
+    field.name = name;
+    field.type_code = get_type_code<Member>();
+    field.offset = offset;
+    field.size = sizeof(Member);
+    field.struct_type_name = nullptr;
+    field.sub_type_code = TYPE_CODE::UNKNOWN;
+
+    if constexpr (std::rank<Member>::value > 1 &&
+                  !std::is_same<typename std::remove_all_extents<Member>::type, char>::value) {
+        // a multi-dimensional array is described as one contiguous block of its innermost elements
+        using SCALAR_TYPE = typename std::remove_all_extents<Member>::type;
+        field.type_code = TYPE_CODE::ARRAY;
+        field.element_size = sizeof(SCALAR_TYPE);
+        field.array_length = sizeof(Member) / sizeof(SCALAR_TYPE);
+        field.rank = std::rank<Member>::value;
+        field.extents = array_extents<Member>::values;
+        field.sub_type_code = array_sub_type_code<SCALAR_TYPE>();
+        if constexpr (array_sub_type_code<SCALAR_TYPE>() == TYPE_CODE::UNKNOWN &&
+                      get_type_code<SCALAR_TYPE>() == TYPE_CODE::STRUCT) {
+            detail::bind_struct_type<SCALAR_TYPE>(field);
+        }
+        field.max_json_size = detail::max_value_size<SCALAR_TYPE>();
+        for (size_t d = field.rank; d > 0; --d) {
+            field.max_json_size = detail::max_array_size(field.extents[d - 1], field.max_json_size);
+        }
+    } else if constexpr (std::is_array<Member>::value) {
+        using ARRAY_ELEMENT_TYPE = typename std::remove_extent<Member>::type;
+        if (!std::is_same<ARRAY_ELEMENT_TYPE, char>::value) {
+            field.type_code = TYPE_CODE::ARRAY;
+            field.element_size = sizeof(ARRAY_ELEMENT_TYPE);
+            field.array_length = std::extent<Member>::value;
+            field.max_json_size =
+                detail::max_array_size(std::extent<Member>::value, detail::max_value_size<ARRAY_ELEMENT_TYPE>());
+        } else {
+            field.max_json_size = detail::max_string_size(std::extent<Member>::value);
+        }
+        field.sub_type_code = array_sub_type_code<ARRAY_ELEMENT_TYPE>();
+        if constexpr (array_sub_type_code<ARRAY_ELEMENT_TYPE>() == TYPE_CODE::UNKNOWN &&
+                      get_type_code<ARRAY_ELEMENT_TYPE>() == TYPE_CODE::STRUCT) {
+            detail::bind_struct_type<ARRAY_ELEMENT_TYPE>(field);
+        }
+    } else if constexpr (is_string_map<Member>::value) {
+        using VALUE_TYPE = typename Member::value_type::second_type;
+        constexpr TYPE_CODE value_type_code = get_type_code<VALUE_TYPE>();
+        static_assert((value_type_code >= TYPE_CODE::CHAR && value_type_code <= TYPE_CODE::BOOL) ||
+                          value_type_code == TYPE_CODE::STD_STRING || value_type_code == TYPE_CODE::STRUCT,
+                      "map fields must hold a basic type, std::string or a registered struct");
+        field.element_size = sizeof(VALUE_TYPE);
+        field.array_length = 0;
+        field.sub_type_code = value_type_code;
+        field.map = &map_ops_of<Member>::ops;
+        if constexpr (value_type_code == TYPE_CODE::STRUCT) {
+            field.struct_metadata = &metadata_of<VALUE_TYPE>;
+            field.struct_index = &detail::find_key_index<VALUE_TYPE>;
+            field.struct_views = &detail::holds_string_views<VALUE_TYPE>;
+        }
+    } else if constexpr (is_std_vector<Member>::value) {
+        using ELEMENT_TYPE = typename Member::value_type;
+        field.element_size = sizeof(ELEMENT_TYPE);
+        field.array_length = 0;
+        field.sub_type_code = array_sub_type_code<ELEMENT_TYPE>();
+        field.sequence = &sequence_ops_of<Member>::ops;
+        if constexpr (array_sub_type_code<ELEMENT_TYPE>() == TYPE_CODE::UNKNOWN &&
+                      get_type_code<ELEMENT_TYPE>() == TYPE_CODE::STRUCT) {
+            field.struct_metadata = &metadata_of<ELEMENT_TYPE>;
+            field.struct_index = &detail::find_key_index<ELEMENT_TYPE>;
+            field.struct_views = &detail::holds_string_views<ELEMENT_TYPE>;
+        }
+    } else if constexpr (is_std_optional<Member>::value) {
+        using VALUE_TYPE = typename Member::value_type;
+        constexpr TYPE_CODE value_type_code = get_type_code<VALUE_TYPE>();
+        static_assert((value_type_code >= TYPE_CODE::CHAR && value_type_code <= TYPE_CODE::BOOL) ||
+                          value_type_code == TYPE_CODE::STD_STRING || value_type_code == TYPE_CODE::STRUCT,
+                      "std::optional fields must hold a basic type, std::string or a registered struct");
+        field.element_size = sizeof(VALUE_TYPE);
+        field.array_length = 0;
+        field.sub_type_code = value_type_code;
+        field.optional = &optional_ops_of<Member>::ops;
+        if constexpr (value_type_code == TYPE_CODE::STRUCT) {
+            detail::bind_struct_type<VALUE_TYPE>(field);
+        }
+        field.max_json_size = detail::max_value_size<VALUE_TYPE>();
+    } else if constexpr (std::is_enum<Member>::value) {
+        field.enumeration = &enum_ops_of<Member>::ops;
+        field.max_json_size = detail::max_enum_size<Member>();
+    } else if constexpr (get_type_code<Member>() == TYPE_CODE::STRUCT) {
+        detail::bind_struct_type<Member>(field);
+        field.max_json_size = detail::max_struct_size<Member>();
+    } else {
+        field.max_json_size = detail::max_basic_size(field.type_code);
+    }
+    return field;
+}
+
+// build the metadata of a fixed array whose live prefix [0, count) is given by a sibling integer member
+template <typename Member, typename Count>
+constexpr field_metadata make_counted_field_metadata(const char* name, size_t offset, size_t count_offset) {
+    static_assert(std::rank<Member>::value == 1 && get_type_code<Member>() == TYPE_CODE::ARRAY,
+                  "only one-dimensional fixed arrays can be bound to a count field");
+    static_assert(std::is_integral<Count>::value && !std::is_same<Count, bool>::value,
+                  "the count field of an array must be an integer");
+    field_metadata field = make_field_metadata<Member>(name, offset);
+    field.count_type_code = get_type_code<Count>();
+    field.count_offset = count_offset;
+    return field;
+}
+
+// mark a one-dimensional array of 1-byte integers (int8_t / uint8_t) as a byte blob emitted as one string
+template <typename Member>
+constexpr field_metadata with_bytes_format(field_metadata field, BYTES_FORMAT format) {
+    using element_type = std::remove_all_extents_t<Member>;
+    static_assert(std::rank<Member>::value == 1 &&
+                      (std::is_same<element_type, signed char>::value ||
+                       std::is_same<element_type, unsigned char>::value),
+                  "only one-dimensional arrays of signed / unsigned char can be encoded as base64 or hex");
+    field.bytes_format = format;
+    field.max_json_size = detail::max_bytes_size(format, std::extent<Member>::value);
+    return field;
+}
+
+// worst-case length of the text to_json_string writes for a registered struct, 0 when the type has fields of
+// unbounded length (std::string, std::string_view, containers) or is not registered through register_json_struct
+template <typename T>
+inline constexpr size_t max_json_size = detail::max_struct_size<T>();
+
+// true when a struct registered with register_json_struct has a std::string_view field, directly or in a nested struct;
+// decoding such a struct points the views into the JSON text, so the text has to outlive the object
+template <typename T>
+inline constexpr bool has_string_view_fields = detail::holds_string_views<T>();
+
+namespace detail {
+
+// live length of a fixed array bound to a count field, the count clamped to [0, array_length]
+inline size_t bounded_length(TYPE_CODE count_type_code, const void* count_ptr, size_t array_length) {
+    long long count = 0;
+    switch (count_type_code) {
+        case TYPE_CODE::CHAR:
+            count = *static_cast<const char*>(count_ptr);
+            break;
+        case TYPE_CODE::S_CHAR:
+            count = *static_cast<const signed char*>(count_ptr);
+            break;
+        case TYPE_CODE::U_CHAR:
+            count = *static_cast<const unsigned char*>(count_ptr);
+            break;
+        case TYPE_CODE::SHORT:
+            count = *static_cast<const short*>(count_ptr);
+            break;
+        case TYPE_CODE::INT:
+            count = *static_cast<const int*>(count_ptr);
+            break;
+        case TYPE_CODE::LONG:
+            count = *static_cast<const long*>(count_ptr);
+            break;
+        case TYPE_CODE::LONG_LONG:
+            count = *static_cast<const long long*>(count_ptr);
+            break;
+        case TYPE_CODE::U_SHORT:
+            count = *static_cast<const unsigned short*>(count_ptr);
+            break;
+        case TYPE_CODE::U_INT:
+            count = *static_cast<const unsigned int*>(count_ptr);
+            break;
+        case TYPE_CODE::U_LONG:
+        case TYPE_CODE::U_LONG_LONG: {
+            const unsigned long long value = count_type_code == TYPE_CODE::U_LONG
+                                                 ? *static_cast<const unsigned long*>(count_ptr)
+                                                 : *static_cast<const unsigned long long*>(count_ptr);
+            return static_cast<size_t>(std::min<unsigned long long>(value, array_length));
+        }
+        default:
+            return array_length;
+    }
+    return count <= 0 ? 0 : static_cast<size_t>(std::min<unsigned long long>(count, array_length));
+}
+
+// store the live length of a fixed array into its count field
+inline void store_count(TYPE_CODE count_type_code, void* count_ptr, size_t count) {
+    switch (count_type_code) {
+        case TYPE_CODE::CHAR:
+            *static_cast<char*>(count_ptr) = static_cast<char>(count);
+            break;
+        case TYPE_CODE::S_CHAR:
+            *static_cast<signed char*>(count_ptr) = static_cast<signed char>(count);
+            break;
+        case TYPE_CODE::U_CHAR:
+            *static_cast<unsigned char*>(count_ptr) = static_cast<unsigned char>(count);
+            break;
+        case TYPE_CODE::SHORT:
+            *static_cast<short*>(count_ptr) = static_cast<short>(count);
+            break;
+        case TYPE_CODE::INT:
+            *static_cast<int*>(count_ptr) = static_cast<int>(count);
+            break;
+        case TYPE_CODE::LONG:
+            *static_cast<long*>(count_ptr) = static_cast<long>(count);
+            break;
+        case TYPE_CODE::LONG_LONG:
+            *static_cast<long long*>(count_ptr) = static_cast<long long>(count);
+            break;
+        case TYPE_CODE::U_SHORT:
+            *static_cast<unsigned short*>(count_ptr) = static_cast<unsigned short>(count);
+            break;
+        case TYPE_CODE::U_INT:
+            *static_cast<unsigned int*>(count_ptr) = static_cast<unsigned int>(count);
+            break;
+        case TYPE_CODE::U_LONG:
+            *static_cast<unsigned long*>(count_ptr) = static_cast<unsigned long>(count);
+            break;
+        case TYPE_CODE::U_LONG_LONG:
+            *static_cast<unsigned long long*>(count_ptr) = static_cast<unsigned long long>(count);
+            break;
+        default:
+            break;
+    }
+}
+
+// number of elements of an array field to encode, the live prefix when the array is bound to a count field
+inline size_t live_length(const field_metadata& field, const void* obj) {
+    if (field.count_type_code == TYPE_CODE::UNKNOWN) {
+        return field.array_length;
+    }
+    return bounded_length(field.count_type_code, static_cast<const char*>(obj) + field.count_offset,
+                          field.array_length);
+}
+
+// record the number of decoded elements of an array field in its count field, if it has one
+inline void set_live_length(const field_metadata& field, void* obj, size_t count) {
+    if (field.count_type_code != TYPE_CODE::UNKNOWN) {
+        store_count(field.count_type_code, static_cast<char*>(obj) + field.count_offset,
+                    std::min(count, field.array_length));
+    }
+}
+
+// distance between consecutive elements of the outermost dimension of a multi-dimensional array
+inline size_t shaped_stride(const size_t* extents, size_t rank, size_t element_size) {
+    size_t stride = element_size;
+    for (size_t d = 1; d < rank; ++d) {
+        stride *= extents[d];
+    }
+    return stride;
+}
+
+// encode a multi-dimensional array as nested JSON arrays; the innermost rows are contiguous, so encode_row converts
+// each of them with the same bulk loop as a one-dimensional array
+template <typename EncodeRow>
+inline nlohmann::json encode_shaped(const size_t* extents, size_t rank, const char* data, size_t element_size,
+                                    const EncodeRow& encode_row) {
+    if (rank == 1) {
+        return encode_row(data, extents[0]);
+    }
+    const size_t stride = shaped_stride(extents, rank, element_size);
+    nlohmann::json array = nlohmann::json::array();
+    auto& elements = *array.get_ptr<nlohmann::json::array_t*>();
+    elements.reserve(extents[0]);
+    for (size_t i = 0; i < extents[0]; ++i) {
+        elements.push_back(encode_shaped(extents + 1, rank - 1, data + i * stride, element_size, encode_row));
+    }
+    return array;
+}
+
+// assign a multi-dimensional array from nested JSON arrays, assign_row fills one innermost row; rows and elements
+// missing from the JSON are left untouched and extra ones are ignored
+template <typename AssignRow>
+inline void assign_shaped(const size_t* extents, size_t rank, const nlohmann::json& value, char* data,
+                          size_t element_size, const AssignRow& assign_row) {
+    if (!value.is_array()) {
+        return;
+    }
+    const size_t count = std::min(value.size(), extents[0]);
+    if (rank == 1) {
+        assign_row(value, data, count);
+        return;
+    }
+    const size_t stride = shaped_stride(extents, rank, element_size);
+    for (size_t i = 0; i < count; ++i) {
+        assign_shaped(extents + 1, rank - 1, value[i], data + i * stride, element_size, assign_row);
+    }
+}
+
+// encode contiguous elements of one basic type as a JSON array
+template <typename V>
+inline nlohmann::json encode_elements(const void* data, size_t count) {
+    nlohmann::json array = nlohmann::json::array();
+    auto& elements = *array.get_ptr<nlohmann::json::array_t*>();
+    elements.reserve(count);
+    const V* values = static_cast<const V*>(data);
+    for (size_t i = 0; i < count; ++i) {
+        elements.emplace_back(values[i]);
+    }
+    return array;
+}
+
+// encode contiguous basic type elements, unrecognized element types are marked like the array walkers do
+inline nlohmann::json encode_basic_elements(TYPE_CODE sub_type_code, const void* data, size_t count) {
+    switch (sub_type_code) {
+        case TYPE_CODE::UNKNOWN:
+            return nlohmann::json::array({"[unknown_array_type]"});
+        case TYPE_CODE::DOUBLE:
+            return encode_elements<double>(data, count);
+        case TYPE_CODE::FLOAT:
+            return encode_elements<float>(data, count);
+        case TYPE_CODE::LONG_LONG:
+            return encode_elements<long long>(data, count);
+        case TYPE_CODE::LONG:
+            return encode_elements<long>(data, count);
+        case TYPE_CODE::INT:
+            return encode_elements<int>(data, count);
+        case TYPE_CODE::SHORT:
+            return encode_elements<short>(data, count);
+        case TYPE_CODE::U_INT:
+            return encode_elements<unsigned int>(data, count);
+        case TYPE_CODE::U_SHORT:
+            return encode_elements<unsigned short>(data, count);
+        case TYPE_CODE::U_LONG:
+            return encode_elements<unsigned long>(data, count);
+        case TYPE_CODE::U_LONG_LONG:
+            return encode_elements<unsigned long long>(data, count);
+        case TYPE_CODE::S_CHAR:
+            return encode_elements<signed char>(data, count);
+        case TYPE_CODE::U_CHAR:
+            return encode_elements<unsigned char>(data, count);
+        case TYPE_CODE::BOOL:
+            return encode_elements<bool>(data, count);
+        default:
+            return nlohmann::json::array({"[unknown_array]"});
+    }
+}
+
+// encode the live elements of a basic type std::vector
+inline nlohmann::json encode_basic_sequence(TYPE_CODE sub_type_code, const sequence_ops& ops, const void* sequence) {
+    const size_t count = ops.size(sequence);
+    const void* data = ops.data(sequence);
+    if (sub_type_code == TYPE_CODE::BOOL && !data) {
+        nlohmann::json array = nlohmann::json::array();
+        for (size_t i = 0; i < count; ++i) {
+            array.push_back(ops.get_bool(sequence, i));
+        }
+        return array;
+    }
+    return encode_basic_elements(sub_type_code, data, count);
+}
+
+// assign one element of a basic type array (or the value of an optional) from a DOM value, values of the wrong JSON
+// type are skipped
+inline void assign_basic_element(TYPE_CODE sub_type_code, const nlohmann::json& value, void* dst) {
+    switch (sub_type_code) {
+        case TYPE_CODE::CHAR:
+            if (value.is_number_unsigned()) {
+                *static_cast<char*>(dst) = static_cast<char>(value.get<uint8_t>());
+            }
+            break;
+        case TYPE_CODE::S_CHAR:
+            if (value.is_number_integer()) {
+                *static_cast<signed char*>(dst) = value.get<signed char>();
+            }
+            break;
+        case TYPE_CODE::U_CHAR:
+            if (value.is_number_unsigned()) {
+                *static_cast<unsigned char*>(dst) = value.get<unsigned char>();
+            }
+            break;
+        case TYPE_CODE::DOUBLE:
+            if (value.is_number()) {
+                *static_cast<double*>(dst) = value.get<double>();
+            }
+            break;
+        case TYPE_CODE::FLOAT:
+            if (value.is_number()) {
+                *static_cast<float*>(dst) = value.get<float>();
+            }
+            break;
+        case TYPE_CODE::LONG_LONG:
+            if (value.is_number_integer()) {
+                *static_cast<long long*>(dst) = value.get<long long>();
+            }
+            break;
+        case TYPE_CODE::LONG:
+            if (value.is_number_integer()) {
+                *static_cast<long*>(dst) = value.get<long>();
+            }
+            break;
+        case TYPE_CODE::INT:
+            if (value.is_number_integer()) {
+                *static_cast<int*>(dst) = value.get<int>();
+            }
+            break;
+        case TYPE_CODE::SHORT:
+            if (value.is_number_integer()) {
+                *static_cast<short*>(dst) = value.get<short>();
+            }
+            break;
+        case TYPE_CODE::U_INT:
+            if (value.is_number_unsigned()) {
+                *static_cast<unsigned int*>(dst) = value.get<unsigned int>();
+            }
+            break;
+        case TYPE_CODE::U_SHORT:
+            if (value.is_number_unsigned()) {
+                *static_cast<unsigned short*>(dst) = value.get<unsigned short>();
+            }
+            break;
+        case TYPE_CODE::U_LONG:
+            if (value.is_number_unsigned()) {
+                *static_cast<unsigned long*>(dst) = value.get<unsigned long>();
+            }
+            break;
+        case TYPE_CODE::U_LONG_LONG:
+            if (value.is_number_unsigned()) {
+                *static_cast<unsigned long long*>(dst) = value.get<unsigned long long>();
+            }
+            break;
+        case TYPE_CODE::BOOL:
+            if (value.is_boolean()) {
+                *static_cast<bool*>(dst) = value.get<bool>();
+            }
+            break;
+        case TYPE_CODE::STD_STRING:
+            if (value.is_string()) {
+                *static_cast<std::string*>(dst) = value.get_ref<const std::string&>();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// encode an associative container as a JSON object, encode_value turns one mapped value into JSON
+template <typename EncodeValue>
+inline nlohmann::json encode_map(const map_ops& ops, const void* map, const EncodeValue& encode_value) {
+    nlohmann::json object = nlohmann::json::object();
+    std::pair<nlohmann::json::object_t*, const EncodeValue*> state{object.get_ptr<nlohmann::json::object_t*>(),
+                                                                   &encode_value};
+    ops.for_each(
+        map,
+        [](void* context, std::string_view key, const void* value) {
+            auto& [members, encode] = *static_cast<decltype(state)*>(context);
+            // std::map and flat maps visit keys in order, so the hint is exact for them
+            members->emplace_hint(members->end(), std::string(key), (*encode)(value));
+        },
+        &state);
+    return object;
+}
+
+// encode an enum value as its registered name, or as an integer in integer mode and for values without a name
+inline nlohmann::json encode_enum(const enum_ops& ops, const void* value) {
+    const long long raw = ops.get(value);
+    if (ops.as_name) {
+        if (const char* name = ops.name_of(raw)) {
+            return name;
+        }
+    }
+    return raw;
+}
+
+// assign an enum from a DOM value, either mode accepts both enumerator names and integers
+inline void assign_enum(const enum_ops& ops, const nlohmann::json& value, void* dst) {
+    if (value.is_number_integer()) {
+        const long long raw = value.get<long long>();
+        // an unsigned DOM integer beyond long long wraps around to a negative value
+        if ((value.is_number_unsigned() && raw < 0) || !ops.in_range(raw)) {
+            throw std::runtime_error("number out of range");
+        }
+        ops.set(dst, raw);
+    } else if (value.is_string()) {
+        long long raw = 0;
+        const std::string& name = value.get_ref<const std::string&>();
+        if (!ops.value_of(name, raw)) {
+            throw std::runtime_error("unknown enumerator: " + name);
+        }
+        ops.set(dst, raw);
+    } else {
+        throw std::runtime_error("value is not an enumerator name or an integer");
+    }
+}
+
+// base64 and hex text of byte arrays
+// the scalar coders are table driven; with SSSE3 enabled at compile time, base64 is encoded 12 bytes and decoded 16
+// characters per step (Mula / Lemire shuffle based coding) and hex is encoded 16 bytes per step, the tail and any
+// block holding padding or invalid characters going through the scalar path
+constexpr char base64_digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+constexpr char hex_digits[] = "0123456789abcdef";
+
+// reverse lookup of a text alphabet, -1 for characters outside of it
+struct digit_table {
+    signed char values[256];
+
+    constexpr digit_table(const char* digits, bool fold_case) : values{} {
+        for (int c = 0; c < 256; ++c) {
+            values[c] = -1;
+        }
+        for (int i = 0; digits[i] != '\0'; ++i) {
+            values[static_cast<unsigned char>(digits[i])] = static_cast<signed char>(i);
+            if (fold_case && digits[i] >= 'a' && digits[i] <= 'z') {
+                values[static_cast<unsigned char>(digits[i] - 'a' + 'A')] = static_cast<signed char>(i);
+            }
+        }
+    }
+
+    int operator[](char c) const {
+        return values[static_cast<unsigned char>(c)];
+    }
+};
+
+inline constexpr digit_table base64_table{base64_digits, false};
+inline constexpr digit_table hex_table{hex_digits, true};
+
+inline size_t base64_length(size_t count) {
+    return (count + 2) / 3 * 4;
+}
+
+// write the base64 text of count bytes to out, which holds base64_length(count) characters
+inline void encode_base64(const unsigned char* data, size_t count, char* out) {
+    size_t i = 0;
+#if defined(__SSSE3__)
+    // 16 bytes are loaded for every 12 encoded, so the vector loop stops 4 bytes short of the end
+    for (; i + 16 <= count; i += 12, out += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // spread each 3-byte group over a 32-bit lane, then move its four 6-bit indices into separate bytes
+        in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+        const __m128i high = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        const __m128i low = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        const __m128i indices = _mm_or_si128(high, low);
+        // map each index range (A-Z, a-z, 0-9, +, /) to the offset that turns it into its digit
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+        const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+        const __m128i digits = _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), digits);
+    }
+#endif
+    for (; i + 3 <= count; i += 3, out += 4) {
+        const uint32_t group = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) | data[i + 2];
+        out[0] = base64_digits[group >> 18];
+        out[1] = base64_digits[(group >> 12) & 0x3F];
+        out[2] = base64_digits[(group >> 6) & 0x3F];
+        out[3] = base64_digits[group & 0x3F];
+    }
+    if (i < count) {
+        const uint32_t group = (uint32_t(data[i]) << 16) | (i + 1 < count ? uint32_t(data[i + 1]) << 8 : 0);
+        out[0] = base64_digits[group >> 18];
+        out[1] = base64_digits[(group >> 12) & 0x3F];
+        out[2] = i + 1 < count ? base64_digits[(group >> 6) & 0x3F] : '=';
+        out[3] = '=';
+    }
+}
+
+// decode base64 text into at most capacity bytes, the rest of a longer payload is validated but dropped; count
+// receives the number of bytes stored, false for text that is not base64 (padding is optional)
+inline bool decode_base64(std::string_view text, unsigned char* out, size_t capacity, size_t& count) {
+    size_t length = text.size();
+    if (length > 0 && text[length - 1] == '=') {
+        --length;
+        if (length > 0 && text[length - 1] == '=') {
+            --length;
+        }
+        if (text.size() % 4 != 0) {
+            return false;
+        }
+    }
+    if (length % 4 == 1) {
+        return false;
+    }
+    size_t i = 0;
+    count = 0;
+#if defined(__SSSE3__)
+    for (; i + 16 <= length && count + 16 <= capacity; i += 16, count += 12) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i));
+        auto between = [&](char low, char high) {
+            return _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8(static_cast<char>(low - 1))),
+                                 _mm_cmplt_epi8(in, _mm_set1_epi8(static_cast<char>(high + 1))));
+        };
+        const __m128i upper = between('A', 'Z');
+        const __m128i lower = between('a', 'z');
+        const __m128i digit = between('0', '9');
+        const __m128i plus = _mm_cmpeq_epi8(in, _mm_set1_epi8('+'));
+        const __m128i slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+        const __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+        if (_mm_movemask_epi8(valid) != 0xFFFF) {
+            break;  // the scalar loop reports the invalid character
+        }
+        __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+        shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+        shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+        shift = _mm_or_si128(shift, _mm_and_si128(plus, _mm_set1_epi8(62 - '+')));
+        shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+        const __m128i values = _mm_add_epi8(in, shift);
+        // merge four 6-bit values into a 24-bit group per 32-bit lane, then pack the groups big-endian
+        const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        const __m128i bytes =
+            _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + count), bytes);
+    }
+#endif
+    for (; i < length; i += 4) {
+        const size_t digits = std::min<size_t>(4, length - i);
+        uint32_t group = 0;
+        for (size_t d = 0; d < 4; ++d) {
+            const int value = d < digits ? base64_table[text[i + d]] : 0;
+            if (value < 0) {
+                return false;
+            }
+            group = (group << 6) | static_cast<uint32_t>(value);
+        }
+        for (size_t b = 0; b + 1 < digits && count < capacity; ++b) {
+            out[count++] = static_cast<unsigned char>(group >> (16 - 8 * b));
+        }
+    }
+    return true;
+}
+
+// write the hex text of count bytes to out, which holds 2 * count characters
+inline void encode_hex(const unsigned char* data, size_t count, char* out) {
+    size_t i = 0;
+#if defined(__SSSE3__)
+    const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex_digits));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    for (; i + 16 <= count; i += 16, out += 32) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(in, 4), nibble));
+        const __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(in, nibble));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(high, low));
+    }
+#endif
+    for (; i < count; ++i, out += 2) {
+        out[0] = hex_digits[data[i] >> 4];
+        out[1] = hex_digits[data[i] & 0x0F];
+    }
+}
+
+// decode hex text (either case) into at most capacity bytes, like decode_base64
+inline bool decode_hex(std::string_view text, unsigned char* out, size_t capacity, size_t& count) {
+    count = 0;
+    if (text.size() % 2 != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < text.size(); i += 2) {
+        const int high = hex_table[text[i]];
+        const int low = hex_table[text[i + 1]];
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        if (count < capacity) {
+            out[count++] = static_cast<unsigned char>((high << 4) | low);
+        }
+    }
+    return true;
+}
+
+// text of the first count bytes of a byte array
+inline std::string encode_bytes(BYTES_FORMAT format, const void* data, size_t count) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::string text(format == BYTES_FORMAT::HEX ? 2 * count : base64_length(count), '\0');
+    if (format == BYTES_FORMAT::HEX) {
+        encode_hex(bytes, count, text.data());
+    } else {
+        encode_base64(bytes, count, text.data());
+    }
+    return text;
+}
+
+// decode the text of a byte array, returns the number of bytes stored; throws on malformed text
+inline size_t decode_bytes(BYTES_FORMAT format, std::string_view text, void* data, size_t capacity) {
+    size_t count = 0;
+    unsigned char* bytes = static_cast<unsigned char*>(data);
+    if (format == BYTES_FORMAT::HEX) {
+        if (!decode_hex(text, bytes, capacity, count)) {
+            throw std::runtime_error("invalid hex string");
+        }
+    } else if (!decode_base64(text, bytes, capacity, count)) {
+        throw std::runtime_error("invalid base64 string");
+    }
+    return count;
+}
+
+// check that a DOM value has the JSON type assign_basic_element expects for a type code
+inline bool matches_basic_value(TYPE_CODE type_code, const nlohmann::json& value) {
+    switch (type_code) {
+        case TYPE_CODE::FLOAT:
+        case TYPE_CODE::DOUBLE:
+            return value.is_number();
+        case TYPE_CODE::S_CHAR:
+        case TYPE_CODE::SHORT:
+        case TYPE_CODE::INT:
+        case TYPE_CODE::LONG:
+        case TYPE_CODE::LONG_LONG:
+            return value.is_number_integer();
+        case TYPE_CODE::CHAR:
+        case TYPE_CODE::U_CHAR:
+        case TYPE_CODE::U_SHORT:
+        case TYPE_CODE::U_INT:
+        case TYPE_CODE::U_LONG:
+        case TYPE_CODE::U_LONG_LONG:
+            return value.is_number_unsigned();
+        case TYPE_CODE::BOOL:
+            return value.is_boolean();
+        case TYPE_CODE::STD_STRING:
+            return value.is_string();
+        default:
+            return false;
+    }
+}
+
+// encode one value of a basic type or std::string the way the field walkers encode a field of that type
+inline nlohmann::json encode_basic_value(TYPE_CODE type_code, const void* value) {
+    switch (type_code) {
+        case TYPE_CODE::CHAR:
+            return static_cast<uint8_t>(*static_cast<const char*>(value));
+        case TYPE_CODE::S_CHAR:
+            return *static_cast<const signed char*>(value);
+        case TYPE_CODE::U_CHAR:
+            return *static_cast<const unsigned char*>(value);
+        case TYPE_CODE::SHORT:
+            return *static_cast<const short*>(value);
+        case TYPE_CODE::INT:
+            return *static_cast<const int*>(value);
+        case TYPE_CODE::LONG:
+            return *static_cast<const long*>(value);
+        case TYPE_CODE::LONG_LONG:
+            return *static_cast<const long long*>(value);
+        case TYPE_CODE::U_SHORT:
+            return *static_cast<const unsigned short*>(value);
+        case TYPE_CODE::U_INT:
+            return *static_cast<const unsigned int*>(value);
+        case TYPE_CODE::U_LONG:
+            return *static_cast<const unsigned long*>(value);
+        case TYPE_CODE::U_LONG_LONG:
+            return *static_cast<const unsigned long long*>(value);
+        case TYPE_CODE::FLOAT:
+            return *static_cast<const float*>(value);
+        case TYPE_CODE::DOUBLE:
+            return *static_cast<const double*>(value);
+        case TYPE_CODE::BOOL:
+            return *static_cast<const bool*>(value);
+        case TYPE_CODE::STD_STRING:
+            return *static_cast<const std::string*>(value);
+        default:
+            return "[unknown_type]";
+    }
+}
+
+}  // namespace detail
+
+// struct to JSON conversion function
+template <typename T>
+nlohmann::json to_json(const T& obj) {
+    JSTON_STATS_SCOPE();
+    JSTON_METRICS_SCOPE(T, encode);
+    return to_json(fields_of<T>(), &obj);
+}
+
+// compile a field mask for a registered struct from dotted paths, e.g. {"id", "name", "car.brand"}
+template <typename T>
+field_mask make_field_mask(const std::vector<std::string>& paths) {
+    const auto& metadata = require_metadata<T>();
+    return field_mask::compile(metadata, paths);
+}
+
+// compile a field mask from a comma separated list of dotted paths, e.g. "id,name,car.brand"
+template <typename T>
+field_mask parse_field_mask(std::string_view fields) {
+    std::vector<std::string> paths;
+    while (!fields.empty()) {
+        const size_t comma = fields.find(',');
+        std::string_view path = fields.substr(0, comma);
+        while (!path.empty() && path.front() == ' ') {
+            path.remove_prefix(1);
+        }
+        while (!path.empty() && path.back() == ' ') {
+            path.remove_suffix(1);
+        }
+        if (!path.empty()) {
+            paths.emplace_back(path);
+        }
+        fields = comma == std::string_view::npos ? std::string_view() : fields.substr(comma + 1);
+    }
+    return make_field_mask<T>(paths);
+}
+
+// struct to JSON conversion function, only the fields selected by the mask are visited and emitted
+template <typename T>
+nlohmann::json to_json(const T& obj, const field_mask& mask) {
+    JSTON_STATS_SCOPE();
+    JSTON_METRICS_SCOPE(T, encode);
+    return to_json(fields_of<T>(), &obj, &mask);
+}
+
+// JSON to struct conversion function
+template <typename T>
+void from_json(const nlohmann::json& j, T& obj) {
+    JSTON_STATS_SCOPE();
+    JSTON_METRICS_SCOPE(T, decode);
+    // check if JSON is an object type
+    if (!j.is_object()) {
+        throw std::runtime_error("JSON value is not an object, cannot convert to struct");
+    }
+
+    from_json(fields_of<T>(), j, &obj);
+}
+
+namespace detail {
+
+// output of the text writer appending to a std::string
+struct string_sink {
+    std::string& text;
+
+    void put(char c) {
+        text += c;
+    }
+    void append(std::string_view data) {
+        text.append(data.data(), data.size());
+    }
+    // room for length characters written in place
+    char* extend(size_t length) {
+        const size_t start = text.size();
+        text.resize(start + length);
+        return &text[start];
+    }
+};
+
+// output of the text writer into a buffer known to hold the worst-case text, nothing is checked
+struct buffer_sink {
+    char* cur;
+
+    void put(char c) {
+        *cur++ = c;
+    }
+    void append(std::string_view data) {
+        memcpy(cur, data.data(), data.size());
+        cur += data.size();
+    }
+    char* extend(size_t length) {
+        char* start = cur;
+        cur += length;
+        return start;
+    }
+};
+
+// direct text writer, defined with the text decoder below
+template <typename Sink>
+inline void write_struct(field_table metadata, const void* obj, const field_mask* mask, Sink& out);
+
+}  // namespace detail
+
+// struct to JSON string conversion function
+// the text is written straight from the field table, with keys in registration order
+template <typename T>
+std::string to_json_string(const T& obj) {
+    JSTON_STATS_SCOPE();
+    JSTON_METRICS_SCOPE(T, encode);
+    std::string result;
+    detail::string_sink out{result};
+    detail::write_struct(fields_of<T>(), &obj, nullptr, out);
+    JSTON_METRICS_BYTES(result.size());
+    return result;
+}
+
+// struct to JSON string conversion function with field projection
+template <typename T>
+std::string to_json_string(const T& obj, const field_mask& mask) {
+    JSTON_STATS_SCOPE();
+    JSTON_METRICS_SCOPE(T, encode);
+    std::string result;
+    detail::string_sink out{result};
+    detail::write_struct(fields_of<T>(), &obj, &mask, out);
+    JSTON_METRICS_BYTES(result.size());
+    return result;
+}
+
+// serialize a registered struct of bounded size into a caller provided buffer, without heap allocation; the buffer
+// is checked once against max_json_size<T> at compile time and the writer then runs without bounds checks. the
+// compile-time field tables of T and its nested structs are walked directly, so not even the first call publishes
+// metadata to the registry (with JSTON_ENABLE_METRICS the first call of a thread still allocates T's counters). the
+// text is NUL terminated, returns its length
+template <typename T, size_t N>
+size_t serialize_to(char (&buffer)[N], const T& obj) {
+    static_assert(max_json_size<T> > 0, "serialize_to needs a struct whose fields all have bounded JSON text");
+    static_assert(N > max_json_size<T>, "buffer cannot hold max_json_size<T> characters and the terminating NUL");
+    JSTON_STATS_SCOPE();
+    JSTON_METRICS_SCOPE(T, encode);
+    detail::buffer_sink out{buffer};
+    detail::write_struct(fields_of<T>(), &obj, nullptr, out);
+    *out.cur = '\0';
+    const size_t length = static_cast<size_t>(out.cur - buffer);
+    JSTON_METRICS_BYTES(length);
+    return length;
+}
+
+// serialize_to for a buffer whose size is only known at run time, checked once against max_json_size<T>
+template <typename T>
+size_t serialize_to(char* buffer, size_t capacity, const T& obj) {
+    static_assert(max_json_size<T> > 0, "serialize_to needs a struct whose fields all have bounded JSON text");
+    if (capacity <= max_json_size<T>) {
+        throw std::runtime_error("buffer of " + std::to_string(capacity) + " bytes is smaller than the " +
+                                 std::to_string(max_json_size<T> + 1) + " bytes serialize_to may need");
+    }
+    JSTON_STATS_SCOPE();
+    JSTON_METRICS_SCOPE(T, encode);
+    detail::buffer_sink out{buffer};
+    detail::write_struct(fields_of<T>(), &obj, nullptr, out);
+    *out.cur = '\0';
+    const size_t length = static_cast<size_t>(out.cur - buffer);
+    JSTON_METRICS_BYTES(length);
+    return length;
+}
+
+// overloaded to_json function, accepts metadata, object pointer and an optional field mask as parameters
+inline nlohmann::json to_json(field_table metadata, const void* obj, const field_mask* mask) {
+    nlohmann::json result = nlohmann::json::object();
+
+    // iterate through all fields and convert
+    for (size_t index = 0; index < metadata.size(); ++index) {
+        const auto& field = metadata[index];
+        // skip fields that are not selected by the mask without visiting them
+        if (mask && !mask->selects(index)) {
+            continue;
+        }
+        const field_mask* child_mask = mask ? mask->child(index) : nullptr;
+        // absent optionals are left out of the object
+        if (field.type_code == TYPE_CODE::OPTIONAL && field.optional &&
+            !field.optional->has_value(reinterpret_cast<const char*>(obj) + field.offset)) {
+            continue;
+        }
+        JSTON_STATS_COUNT(fields_encoded);
+        const field_table nested = has_struct_type(field) ? nested_table(field) : field_table();
+        const field_table* struct_metadata = nested.fields ? &nested : nullptr;
+        try {
+            // handle differently based on field type
+            switch (field.type_code) {
+                case TYPE_CODE::CHAR: {
+                    const char& value =
+                        *reinterpret_cast<const char*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = static_cast<uint8_t>(value);
+                    break;
+                }
+                case TYPE_CODE::S_CHAR: {
+                    const signed char& value =
+                        *reinterpret_cast<const signed char*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = value;
+                    break;
+                }
+                case TYPE_CODE::U_CHAR: {
+                    const unsigned char& value =
+                        *reinterpret_cast<const unsigned char*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = value;
+                    break;
+                }
+                case TYPE_CODE::SHORT: {
+                    const short& value =
+                        *reinterpret_cast<const short*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = value;
+                    break;
+                }
+                case TYPE_CODE::INT: {
+                    const int& value = *reinterpret_cast<const int*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = value;
+                    break;
+                }
+                case TYPE_CODE::LONG: {
+                    const long& value =
+                        *reinterpret_cast<const long*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = value;
+                    break;
+                }
+                case TYPE_CODE::LONG_LONG: {
+                    const long long& value =
+                        *reinterpret_cast<const long long*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = value;
+                    break;
+                }
+                case TYPE_CODE::U_SHORT: {
+                    const unsigned short& value =
+                        *reinterpret_cast<const unsigned short*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = value;
+                    break;
+                }
+                case TYPE_CODE::U_INT: {
+                    const unsigned int& value =
+                        *reinterpret_cast<const unsigned int*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = value;
+                    break;
+                }
+                case TYPE_CODE::U_LONG: {
+                    const unsigned long& value =
+                        *reinterpret_cast<const unsigned long*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = value;
+                    break;
+                }
+                case TYPE_CODE::U_LONG_LONG: {
+                    const unsigned long long& value =
+                        *reinterpret_cast<const unsigned long long*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = value;
+                    break;
+                }
+                case TYPE_CODE::FLOAT: {
+                    const float& value =
+                        *reinterpret_cast<const float*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = value;
+                    break;
+                }
+                case TYPE_CODE::DOUBLE: {
+                    const double& value =
+                        *reinterpret_cast<const double*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = value;
+                    break;
+                }
+                case TYPE_CODE::BOOL: {
+                    const bool& value =
+                        *reinterpret_cast<const bool*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = value;
+                    break;
+                }
+                case TYPE_CODE::STRING: {
+                    // char array
+                    const char* value =
+                        reinterpret_cast<const char*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    // create a safe std::string, handle only ascii characters
+                    std::string safe_string;
+                    size_t max_chars = field.size > 0 ? field.size : 256;  // use field size or default value
+                    for (size_t i = 0; i < max_chars; ++i) {
+                        unsigned char c = static_cast<unsigned char>(value[i]);
+                        if (c == '\0') {
+                            break;  // end of string
+                        }
+                        if (c < 128) {
+                            safe_string += c;  // add only ASCII characters
+                        }
+                    }
+                    result[field.name] = safe_string;
+                    break;
+                }
+                case TYPE_CODE::STD_STRING: {
+                    result[field.name] =
+                        *reinterpret_cast<const std::string*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    break;
+                }
+                case TYPE_CODE::STRING_VIEW: {
+                    const std::string_view& value =
+                        *reinterpret_cast<const std::string_view*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    result[field.name] = std::string(value);
+                    break;
+                }
+                case TYPE_CODE::FUNCTION: {
+                    // simplified handling for function pointers
+                    result[field.name] = "[function_pointer]";
+                    break;
+                }
+                case TYPE_CODE::POINTER: {
+                    // get the pointer value is not necessary
+                    result[field.name] = "[pointer]";
+                    break;
+                }
+                case TYPE_CODE::STRUCT: {
+                    // handle nested struct
+                    const void* struct_ptr =
+                        reinterpret_cast<const void*>(reinterpret_cast<const char*>(obj) + field.offset);
+
+                    // get struct type name and convert
+                    if (has_struct_type(field)) {
+                        if (struct_metadata) {
+                            result[field.name] = jston::to_json(*struct_metadata, struct_ptr, child_mask);
+                        } else {
+                            result[field.name] = "[struct]";
+                        }
+                    } else {
+                        result[field.name] = "[struct]";
+                    }
+                    break;
+                }
+                case TYPE_CODE::ARRAY: {  // handle array
+                    const void* array_ptr =
+                        reinterpret_cast<const void*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    nlohmann::json array = nlohmann::json::array();
+
+                    // multi-dimensional arrays become nested arrays, converted one contiguous innermost row at a time
+                    if (field.rank > 1 && field.extents) {
+                        result[field.name] = detail::encode_shaped(
+                            field.extents, field.rank, static_cast<const char*>(array_ptr), field.element_size,
+                            [&](const char* row, size_t row_length) {
+                                if (!has_struct_type(field)) {
+                                    return detail::encode_basic_elements(field.sub_type_code, row, row_length);
+                                }
+                                nlohmann::json elements = nlohmann::json::array();
+                                for (size_t i = 0; i < row_length && struct_metadata; ++i) {
+                                    elements.push_back(
+                                        jston::to_json(*struct_metadata, row + i * field.element_size, child_mask));
+                                }
+                                return elements;
+                            });
+                        break;
+                    }
+
+                    // byte arrays with a text encoding become one string holding their live prefix
+                    if (field.bytes_format != BYTES_FORMAT::ARRAY) {
+                        result[field.name] =
+                            detail::encode_bytes(field.bytes_format, array_ptr, detail::live_length(field, obj));
+                        break;
+                    }
+
+                    // prefer to use precomputed array element size and length
+                    if (field.element_size > 0 && field.array_length > 0) {
+                        // only the live prefix of an array bound to a count field is emitted
+                        const size_t live = detail::live_length(field, obj);
+                        // handle struct array
+                        if (has_struct_type(field)) {
+                            // try to find corresponding struct metadata
+                            if (struct_metadata) {
+                                // iterate through each element in array
+                                for (size_t i = 0; i < live; ++i) {
+                                    const void* element_ptr =
+                                        static_cast<const char*>(array_ptr) + i * field.element_size;
+                                    nlohmann::json element_json =
+                                        jston::to_json(*struct_metadata, element_ptr, child_mask);
+                                    array.push_back(element_json);
+                                }
+                            }
+                        } else {
+                            // handle basic type array
+                            // note: even if sub_type_code is UNKNOWN, we still try to handle to avoid random values
+                            // from uninitialized arrays for unrecognized types, we mark them as [unknown_array_type]
+                            if (field.sub_type_code == TYPE_CODE::UNKNOWN) {
+                                array.push_back("[unknown_array_type]");
+                            } else {
+                                switch (field.sub_type_code) {
+                                    case TYPE_CODE::DOUBLE: {
+                                        const double* double_array = static_cast<const double*>(array_ptr);
+                                        for (size_t i = 0; i < live; ++i) {
+                                            array.push_back(double_array[i]);
+                                        }
+                                        break;
+                                    }
+                                    case TYPE_CODE::FLOAT: {
+                                        const float* float_array = static_cast<const float*>(array_ptr);
+                                        for (size_t i = 0; i < live; ++i) {
+                                            array.push_back(float_array[i]);
+                                        }
+                                        break;
+                                    }
+                                    case TYPE_CODE::LONG_LONG: {
+                                        const long long* longlong_array = static_cast<const long long*>(array_ptr);
+                                        for (size_t i = 0; i < live; ++i) {
+                                            array.push_back(longlong_array[i]);
+                                        }
+                                        break;
+                                    }
+                                    case TYPE_CODE::LONG: {
+                                        const long* long_array = static_cast<const long*>(array_ptr);
+                                        for (size_t i = 0; i < live; ++i) {
+                                            array.push_back(long_array[i]);
+                                        }
+                                        break;
+                                    }
+                                    case TYPE_CODE::INT: {
+                                        const int* int_array = static_cast<const int*>(array_ptr);
+                                        for (size_t i = 0; i < live; ++i) {
+                                            array.push_back(int_array[i]);
+                                        }
+                                        break;
+                                    }
+                                    case TYPE_CODE::SHORT: {
+                                        const short* short_array = static_cast<const short*>(array_ptr);
+                                        for (size_t i = 0; i < live; ++i) {
+                                            array.push_back(short_array[i]);
+                                        }
+                                        break;
+                                    }
+                                    case TYPE_CODE::U_INT: {
+                                        const unsigned int* uint_array = static_cast<const unsigned int*>(array_ptr);
+                                        for (size_t i = 0; i < live; ++i) {
+                                            array.push_back(uint_array[i]);
+                                        }
+                                        break;
+                                    }
+                                    case TYPE_CODE::U_SHORT: {
+                                        const unsigned short* ushort_array =
+                                            static_cast<const unsigned short*>(array_ptr);
+                                        for (size_t i = 0; i < live; ++i) {
+                                            array.push_back(ushort_array[i]);
+                                        }
+                                        break;
+                                    }
+                                    case TYPE_CODE::BOOL: {
+                                        const bool* bool_array = static_cast<const bool*>(array_ptr);
+                                        for (size_t i = 0; i < live; ++i) {
+                                            array.push_back(bool_array[i]);
+                                        }
+                                        break;
+                                    }
+                                    case TYPE_CODE::U_LONG:
+                                    case TYPE_CODE::U_LONG_LONG:
+                                    case TYPE_CODE::S_CHAR:
+                                    case TYPE_CODE::U_CHAR:
+                                        array = detail::encode_basic_elements(field.sub_type_code, array_ptr, live);
+                                        break;
+                                    default:
+                                        // unrecognized array type
+                                        array.push_back("[unknown_array]");
+                                        break;
+                                }
+                            }
+                        }
+                    } else {
+                        // use traditional method to handle arrays as fallback solution
+                        // handling priority: 1. prefer the registered struct type for precise matching
+                        // first check if the field refers to a struct type
+                        if (has_struct_type(field)) {
+                            // try to find corresponding struct metadata
+                            if (struct_metadata) {
+                                // calculate array element size
+                                size_t element_size = 0;
+                                for (const auto& f : *struct_metadata) {
+                                    size_t field_end = f.offset + (f.size > 0 ? f.size : sizeof(void*));
+                                    if (field_end > element_size) {
+                                        element_size = field_end;
+                                    }
+                                }
+
+                                // ensure alignment
+                                element_size = (element_size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+                                // calculate number of elements in array
+                                int array_size = field.size / element_size;
+
+                                // iterate through each element in array
+                                for (int i = 0; i < array_size; ++i) {
+                                    const void* element_ptr = static_cast<const char*>(array_ptr) + i * element_size;
+                                    nlohmann::json element_json =
+                                        jston::to_json(*struct_metadata, element_ptr, child_mask);
+                                    array.push_back(element_json);
+                                }
+                            } else {
+                                // not a struct array, use sub_type_code to precisely match basic type array
+                                // this is the main matching method to ensure type safety and precise conversion
+                                if (field.sub_type_code == TYPE_CODE::DOUBLE) {
+                                    const double* double_array = static_cast<const double*>(array_ptr);
+                                    int array_size = field.size / sizeof(double);
+                                    for (int i = 0; i < array_size; ++i) {
+                                        array.push_back(double_array[i]);
+                                    }
+                                } else if (field.sub_type_code == TYPE_CODE::FLOAT) {
+                                    const float* float_array = static_cast<const float*>(array_ptr);
+                                    int array_size = field.size / sizeof(float);
+                                    for (int i = 0; i < array_size; ++i) {
+                                        array.push_back(float_array[i]);
+                                    }
+                                } else if (field.sub_type_code == TYPE_CODE::LONG_LONG) {
+                                    const long long* longlong_array = static_cast<const long long*>(array_ptr);
+                                    int array_size = field.size / sizeof(long long);
+                                    for (int i = 0; i < array_size; ++i) {
+                                        array.push_back(longlong_array[i]);
+                                    }
+                                } else if (field.sub_type_code == TYPE_CODE::LONG) {
+                                    const long* long_array = static_cast<const long*>(array_ptr);
+                                    int array_size = field.size / sizeof(long);
+                                    for (int i = 0; i < array_size; ++i) {
+                                        array.push_back(long_array[i]);
+                                    }
+                                } else if (field.sub_type_code == TYPE_CODE::INT) {
+                                    const int* int_array = static_cast<const int*>(array_ptr);
+                                    int array_size = field.size / sizeof(int);
+                                    for (int i = 0; i < array_size; ++i) {
+                                        array.push_back(int_array[i]);
+                                    }
+                                } else if (field.sub_type_code == TYPE_CODE::SHORT) {
+                                    const short* short_array = static_cast<const short*>(array_ptr);
+                                    int array_size = field.size / sizeof(short);
+                                    for (int i = 0; i < array_size; ++i) {
+                                        array.push_back(short_array[i]);
+                                    }
+                                } else if (field.sub_type_code == TYPE_CODE::U_INT) {
+                                    const unsigned int* uint_array = static_cast<const unsigned int*>(array_ptr);
+                                    int array_size = field.size / sizeof(unsigned int);
+                                    for (int i = 0; i < array_size; ++i) {
+                                        array.push_back(uint_array[i]);
+                                    }
+                                } else if (field.sub_type_code == TYPE_CODE::U_SHORT) {
+                                    const unsigned short* ushort_array = static_cast<const unsigned short*>(array_ptr);
+                                    int array_size = field.size / sizeof(unsigned short);
+                                    for (int i = 0; i < array_size; ++i) {
+                                        array.push_back(ushort_array[i]);
+                                    }
+                                } else if (field.sub_type_code == TYPE_CODE::BOOL) {
+                                    const bool* bool_array = static_cast<const bool*>(array_ptr);
+                                    int array_size = field.size / sizeof(bool);
+                                    for (int i = 0; i < array_size; ++i) {
+                                        array.push_back(bool_array[i]);
+                                    }
+                                } else {
+                                    // unrecognized array type
+                                    array.push_back("[unknown_array]");
+                                }
+                            }
+                        }
+                    }
+                    // only add this field if it doesn't exist in result yet
+                    if (!result.contains(field.name)) {
+                        result[field.name] = array;
+                    }
+                    break;
+                }
+                case TYPE_CODE::VECTOR: {
+                    // only the live elements are emitted
+                    if (!field.sequence) {
+                        result[field.name] = "[unknown_type]";
+                        break;
+                    }
+                    const void* sequence =
+                        reinterpret_cast<const void*>(reinterpret_cast<const char*>(obj) + field.offset);
+                    if (!has_struct_type(field)) {
+                        result[field.name] =
+                            detail::encode_basic_sequence(field.sub_type_code, *field.sequence, sequence);
+                        break;
+                    }
+                    nlohmann::json array = nlohmann::json::array();
+                    if (struct_metadata) {
+                        const size_t count = field.sequence->size(sequence);
+                        const char* data = static_cast<const char*>(field.sequence->data(sequence));
+                        for (size_t i = 0; i < count; ++i) {
+                            const char* element_ptr = data + i * field.element_size;
+                            array.push_back(jston::to_json(*struct_metadata, element_ptr, child_mask));
+                        }
+                    }
+                    result[field.name] = std::move(array);
+                    break;
+                }
+                case TYPE_CODE::MAP: {
+                    if (!field.map) {
+                        result[field.name] = "[unknown_type]";
+                        break;
+                    }
+                    result[field.name] = detail::encode_map(
+                        *field.map, reinterpret_cast<const char*>(obj) + field.offset, [&](const void* value) {
+                            if (struct_metadata) {
+                                return jston::to_json(*struct_metadata, value, child_mask);
+                            }
+                            return has_struct_type(field) ? nlohmann::json("[struct]")
+                                                          : detail::encode_basic_value(field.sub_type_code, value);
+                        });
+                    break;
+                }
+                case TYPE_CODE::ENUM: {
+                    if (!field.enumeration) {
+                        result[field.name] = "[unknown_type]";
+                        break;
+                    }
+                    result[field.name] =
+                        detail::encode_enum(*field.enumeration, reinterpret_cast<const char*>(obj) + field.offset);
+                    break;
+                }
+                case TYPE_CODE::OPTIONAL: {
+                    if (!field.optional) {
+                        result[field.name] = "[unknown_type]";
+                        break;
+                    }
+                    const void* value =
+                        field.optional->value(reinterpret_cast<const char*>(obj) + field.offset);
+                    if (!has_struct_type(field)) {
+                        result[field.name] = detail::encode_basic_value(field.sub_type_code, value);
+                        break;
+                    }
+                    if (struct_metadata) {
+                        result[field.name] = jston::to_json(*struct_metadata, value, child_mask);
+                    } else {
+                        result[field.name] = "[struct]";
+                    }
+                    break;
+                }
+                default:
+                    result[field.name] = "[unknown_type]";
+                    break;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error converting field '" << field.name << "': " << e.what() << std::endl;
+            result[field.name] = "[error]";
+        }
+    }
+
+    return result;
+}
+
+// three-parameter from_json function implementation
+inline void from_json(field_table metadata, const nlohmann::json& j, void* obj) {
+    // iterate through all fields and convert
+    for (const auto& field : metadata) {
+        try {
+            // check if field exists and is not null, null clears an optional and leaves other fields untouched
+            if (j.find(field.name) == j.end()) {
+                continue;
+            }
+            if (j[field.name].is_null()) {
+                if (field.type_code == TYPE_CODE::OPTIONAL && field.optional) {
+                    field.optional->reset(reinterpret_cast<char*>(obj) + field.offset);
+                }
+                continue;
+            }
+            JSTON_STATS_COUNT(fields_decoded);
+            const field_table nested = has_struct_type(field) ? nested_table(field) : field_table();
+            const field_table* struct_metadata = nested.fields ? &nested : nullptr;
+
+            // handle differently based on field type
+            switch (field.type_code) {
+                case TYPE_CODE::CHAR: {
+                    char& value = *reinterpret_cast<char*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = static_cast<char>(j[field.name].get<uint8_t>());
+                    break;
+                }
+                case TYPE_CODE::S_CHAR: {
+                    signed char& value = *reinterpret_cast<signed char*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get<signed char>();
+                    break;
+                }
+                case TYPE_CODE::U_CHAR: {
+                    unsigned char& value =
+                        *reinterpret_cast<unsigned char*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get<unsigned char>();
+                    break;
+                }
+                case TYPE_CODE::SHORT: {
+                    short& value = *reinterpret_cast<short*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get<short>();
+                    break;
+                }
+                case TYPE_CODE::INT: {
+                    int& value = *reinterpret_cast<int*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get<int>();
+                    break;
+                }
+                case TYPE_CODE::LONG: {
+                    long& value = *reinterpret_cast<long*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get<long>();
+                    break;
+                }
+                case TYPE_CODE::LONG_LONG: {
+                    long long& value = *reinterpret_cast<long long*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get<long long>();
+                    break;
+                }
+                case TYPE_CODE::U_SHORT: {
+                    unsigned short& value =
+                        *reinterpret_cast<unsigned short*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get<unsigned short>();
+                    break;
+                }
+                case TYPE_CODE::U_INT: {
+                    unsigned int& value = *reinterpret_cast<unsigned int*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get<unsigned int>();
+                    break;
+                }
+                case TYPE_CODE::U_LONG: {
+                    unsigned long& value =
+                        *reinterpret_cast<unsigned long*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get<unsigned long>();
+                    break;
+                }
+                case TYPE_CODE::U_LONG_LONG: {
+                    unsigned long long& value =
+                        *reinterpret_cast<unsigned long long*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get<unsigned long long>();
+                    break;
+                }
+                case TYPE_CODE::FLOAT: {
+                    float& value = *reinterpret_cast<float*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get<float>();
+                    break;
+                }
+                case TYPE_CODE::DOUBLE: {
+                    double& value = *reinterpret_cast<double*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get<double>();
+                    break;
+                }
+                case TYPE_CODE::BOOL: {
+                    bool& value = *reinterpret_cast<bool*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get<bool>();
+                    break;
+                }
+                case TYPE_CODE::STRING: {
+                    // check if this is a char pointer (char* or const char*)
+                    if (std::is_pointer<decltype(*reinterpret_cast<void**>(reinterpret_cast<char*>(obj) + field.offset))>::value) {
+                        // for char pointers, we don't perform deserialization as we can't know where to allocate memory
+                        // just leave the pointer as it is (null or existing)
+                        break;
+                    }
+                    // regular char array (c-style string) handling
+                    char* value = reinterpret_cast<char*>(reinterpret_cast<char*>(obj) + field.offset);
+                    try {
+                        std::string str_value = j[field.name].get<std::string>();
+                        // use strncpy to prevent overflow and manually add string terminator
+                        if (field.size > 0) {
+                            strncpy(value, str_value.c_str(), field.size - 1);
+                            value[field.size - 1] = '\0';  // ensure string termination
+                        }
+                    } catch (const std::exception& e) {
+                        // handle potential string conversion errors
+                        throw std::runtime_error(
+                            std::string("Error converting field '" + std::string(field.name) + "': ") + e.what());
+                    }
+                    break;
+                }
+                case TYPE_CODE::STD_STRING: {
+                    // assignment reuses the capacity the member already has
+                    std::string& value = *reinterpret_cast<std::string*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get_ref<const std::string&>();
+                    break;
+                }
+                case TYPE_CODE::STRING_VIEW: {
+                    // the view points into the JSON value, which must outlive the struct
+                    std::string_view& value =
+                        *reinterpret_cast<std::string_view*>(reinterpret_cast<char*>(obj) + field.offset);
+                    value = j[field.name].get_ref<const std::string&>();
+                    break;
+                }
+                case TYPE_CODE::FUNCTION: {
+                    // do not deserialize function pointers
+                    break;
+                }
+                case TYPE_CODE::POINTER: {
+                    // explicitly set pointer types to null during deserialization
+                    void** ptr = reinterpret_cast<void**>(reinterpret_cast<char*>(obj) + field.offset);
+                    *ptr = nullptr;
+                    break;
+                }
+                case TYPE_CODE::STRUCT: {
+                    // handle nested struct
+                    void* struct_ptr = reinterpret_cast<void*>(reinterpret_cast<char*>(obj) + field.offset);
+
+                    // dynamically call from_json based on struct type name
+                    if (has_struct_type(field)) {
+                        // get metadata for struct type
+                        if (struct_metadata) {
+                            // check if field exists in JSON and is not null
+                            if (j.find(field.name) != j.end() && !j[field.name].is_null()) {
+                                ::jston::from_json(*struct_metadata, j[field.name], struct_ptr);
+                            }
+                        }
+                    }
+                    break;
+                }
+                case TYPE_CODE::ARRAY: {
+                    // handle array
+                    void* array_ptr = reinterpret_cast<void*>(reinterpret_cast<char*>(obj) + field.offset);
+                    if (field.bytes_format != BYTES_FORMAT::ARRAY && j.contains(field.name) &&
+                        j[field.name].is_string()) {
+                        const std::string& text = j[field.name].get_ref<const std::string&>();
+                        detail::set_live_length(field, obj,
+                                                detail::decode_bytes(field.bytes_format, text, array_ptr, field.size));
+                        break;
+                    }
+                    if (!j.contains(field.name) || !j[field.name].is_array()) {
+                        continue;
+                    }
+
+                    const auto& json_array = j[field.name];
+
+                    // multi-dimensional arrays are read from nested arrays, one innermost row at a time
+                    if (field.rank > 1 && field.extents) {
+                        detail::assign_shaped(
+                            field.extents, field.rank, json_array, static_cast<char*>(array_ptr), field.element_size,
+                            [&](const nlohmann::json& row, char* data, size_t count) {
+                                for (size_t i = 0; i < count; ++i) {
+                                    char* element = data + i * field.element_size;
+                                    if (!has_struct_type(field)) {
+                                        detail::assign_basic_element(field.sub_type_code, row[i], element);
+                                    } else if (struct_metadata && row[i].is_object()) {
+                                        ::jston::from_json(*struct_metadata, row[i], element);
+                                    }
+                                }
+                            });
+                        break;
+                    }
+
+                    // first try as struct array
+                    if (has_struct_type(field)) {
+                        // get metadata for struct type
+                        if (struct_metadata) {
+                            // prefer to use precomputed element_size and array_length
+                            size_t element_size = field.element_size > 0 ? field.element_size : 0;
+
+                            // iterate through each element in array, never past its capacity
+                            const size_t count = field.array_length > 0
+                                                     ? std::min(json_array.size(), field.array_length)
+                                                     : json_array.size();
+                            for (size_t i = 0; i < count; ++i) {
+                                void* element_ptr = static_cast<char*>(array_ptr) + i * element_size;
+                                ::jston::from_json(*struct_metadata, json_array[i], element_ptr);
+                            }
+                        }
+                    } else {
+                        if (field.sub_type_code == TYPE_CODE::DOUBLE) {
+                            double* double_array = static_cast<double*>(array_ptr);
+                            int array_size;
+                            if (field.array_length > 0) {
+                                array_size =
+                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
+                            } else {
+                                array_size = std::min(static_cast<int>(json_array.size()),
+                                                      static_cast<int>(field.size / sizeof(double)));
+                            }
+                            for (int i = 0; i < array_size; ++i) {
+                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number()) {
+                                    double_array[i] = json_array[i].get<double>();
+                                }
+                            }
+                        } else if (field.sub_type_code == TYPE_CODE::FLOAT) {
+                            float* float_array = static_cast<float*>(array_ptr);
+                            int array_size;
+                            if (field.array_length > 0) {
+                                array_size =
+                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
+                            } else {
+                                array_size = std::min(static_cast<int>(json_array.size()),
+                                                      static_cast<int>(field.size / sizeof(float)));
+                            }
+                            for (int i = 0; i < array_size; ++i) {
+                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number()) {
+                                    float_array[i] = json_array[i].get<float>();
+                                }
+                            }
+                        } else if (field.sub_type_code == TYPE_CODE::LONG_LONG) {
+                            long long* longlong_array = static_cast<long long*>(array_ptr);
+                            int array_size;
+                            if (field.array_length > 0) {
+                                array_size =
+                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
+                            } else {
+                                array_size = std::min(static_cast<int>(json_array.size()),
+                                                      static_cast<int>(field.size / sizeof(long long)));
+                            }
+                            for (int i = 0; i < array_size; ++i) {
+                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number_integer()) {
+                                    longlong_array[i] = json_array[i].get<long long>();
+                                }
+                            }
+                        } else if (field.sub_type_code == TYPE_CODE::LONG) {
+                            long* long_array = static_cast<long*>(array_ptr);
+                            int array_size;
+                            if (field.array_length > 0) {
+                                array_size =
+                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
+                            } else {
+                                array_size = std::min(static_cast<int>(json_array.size()),
+                                                      static_cast<int>(field.size / sizeof(long)));
+                            }
+                            for (int i = 0; i < array_size; ++i) {
+                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number_integer()) {
+                                    long_array[i] = json_array[i].get<long>();
+                                }
+                            }
+                        } else if (field.sub_type_code == TYPE_CODE::INT) {
+                            int* int_array = static_cast<int*>(array_ptr);
+                            int array_size;
+                            if (field.array_length > 0) {
+                                array_size =
+                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
+                            } else {
+                                array_size = std::min(static_cast<int>(json_array.size()),
+                                                      static_cast<int>(field.size / sizeof(int)));
+                            }
+                            for (int i = 0; i < array_size; ++i) {
+                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number_integer()) {
+                                    int_array[i] = json_array[i].get<int>();
+                                }
+                            }
+                        } else if (field.sub_type_code == TYPE_CODE::SHORT) {
+                            short* short_array = static_cast<short*>(array_ptr);
+                            int array_size;
+                            if (field.array_length > 0) {
+                                array_size =
+                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
+                            } else {
+                                array_size = std::min(static_cast<int>(json_array.size()),
+                                                      static_cast<int>(field.size / sizeof(short)));
+                            }
+                            for (int i = 0; i < array_size; ++i) {
+                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number_integer()) {
+                                    short_array[i] = json_array[i].get<short>();
+                                }
+                            }
+                        } else if (field.sub_type_code == TYPE_CODE::U_INT) {
+                            unsigned int* uint_array = static_cast<unsigned int*>(array_ptr);
+                            int array_size;
+                            if (field.array_length > 0) {
+                                array_size =
+                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
+                            } else {
+                                array_size = std::min(static_cast<int>(json_array.size()),
+                                                      static_cast<int>(field.size / sizeof(unsigned int)));
+                            }
+                            for (int i = 0; i < array_size; ++i) {
+                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number_unsigned()) {
+                                    uint_array[i] = json_array[i].get<unsigned int>();
+                                }
+                            }
+                        } else if (field.sub_type_code == TYPE_CODE::U_SHORT) {
+                            unsigned short* ushort_array = static_cast<unsigned short*>(array_ptr);
+                            int array_size;
+                            if (field.array_length > 0) {
+                                array_size =
+                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
+                            } else {
+                                array_size = std::min(static_cast<int>(json_array.size()),
+                                                      static_cast<int>(field.size / sizeof(unsigned short)));
+                            }
+                            for (int i = 0; i < array_size; ++i) {
+                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number_unsigned()) {
+                                    ushort_array[i] = json_array[i].get<unsigned short>();
+                                }
+                            }
+                        } else if (field.sub_type_code == TYPE_CODE::BOOL) {
+                            bool* bool_array = static_cast<bool*>(array_ptr);
+                            int array_size;
+                            if (field.array_length > 0) {
+                                array_size =
+                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
+                            } else {
+                                array_size = std::min(static_cast<int>(json_array.size()),
+                                                      static_cast<int>(field.size / sizeof(bool)));
+                            }
+                            for (int i = 0; i < array_size; ++i) {
+                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_boolean()) {
+                                    bool_array[i] = json_array[i].get<bool>();
+                                }
+                            }
+                        } else if (field.sub_type_code != TYPE_CODE::UNKNOWN && field.element_size > 0) {
+                            // remaining element types share the checked element assignment
+                            char* element_array = static_cast<char*>(array_ptr);
+                            const size_t capacity =
+                                field.array_length > 0 ? field.array_length : field.size / field.element_size;
+                            const size_t array_size = std::min(json_array.size(), capacity);
+                            for (size_t i = 0; i < array_size; ++i) {
+                                detail::assign_basic_element(field.sub_type_code, json_array[i],
+                                                             element_array + i * field.element_size);
+                            }
+                        } else {
+                            // unrecognized basic type array
+                            std::cerr << "Error: Unknown basic type array for field '" << field.name << "'"
+                                      << std::endl;
+                        }
+                    }
+                    detail::set_live_length(field, obj, json_array.size());
+                } break;
+                case TYPE_CODE::VECTOR: {
+                    const auto& json_array = j[field.name];
+                    if (!field.sequence || !json_array.is_array()) {
+                        break;
+                    }
+                    // resizing keeps the capacity and the existing elements, which are decoded in place
+                    void* sequence = reinterpret_cast<void*>(reinterpret_cast<char*>(obj) + field.offset);
+                    const sequence_ops& ops = *field.sequence;
+                    if (has_struct_type(field)) {
+                        if (!struct_metadata) {
+                            break;
+                        }
+                        ops.resize(sequence, json_array.size());
+                        char* data = static_cast<char*>(ops.mutable_data(sequence));
+                        for (size_t i = 0; i < json_array.size(); ++i) {
+                            ::jston::from_json(*struct_metadata, json_array[i], data + i * field.element_size);
+                        }
+                    } else if (field.sub_type_code != TYPE_CODE::UNKNOWN) {
+                        ops.resize(sequence, json_array.size());
+                        char* data = static_cast<char*>(ops.mutable_data(sequence));
+                        for (size_t i = 0; i < json_array.size(); ++i) {
+                            if (!data) {
+                                if (json_array[i].is_boolean()) {
+                                    ops.set_bool(sequence, i, json_array[i].get<bool>());
+                                }
+                            } else {
+                                detail::assign_basic_element(field.sub_type_code, json_array[i],
+                                                             data + i * field.element_size);
+                            }
+                        }
+                    } else {
+                        std::cerr << "Error: Unknown basic type array for field '" << field.name << "'" << std::endl;
+                    }
+                    break;
+                }
+                case TYPE_CODE::MAP: {
+                    // the container is refilled from the object, reserving for its size up front
+                    const auto& object = j[field.name];
+                    if (!field.map || !object.is_object() || (has_struct_type(field) && !struct_metadata)) {
+                        break;
+                    }
+                    void* map = reinterpret_cast<void*>(reinterpret_cast<char*>(obj) + field.offset);
+                    const map_ops& ops = *field.map;
+                    ops.clear(map);
+                    if (ops.reserve) {
+                        ops.reserve(map, object.size());
+                    }
+                    for (auto it = object.begin(); it != object.end(); ++it) {
+                        void* value = ops.emplace(map, it.key());
+                        if (!struct_metadata) {
+                            detail::assign_basic_element(field.sub_type_code, it.value(), value);
+                        } else if (it.value().is_object()) {
+                            ::jston::from_json(*struct_metadata, it.value(), value);
+                        }
+                    }
+                    ops.finish(map);
+                    break;
+                }
+                case TYPE_CODE::ENUM: {
+                    if (field.enumeration) {
+                        detail::assign_enum(*field.enumeration, j[field.name],
+                                            reinterpret_cast<char*>(obj) + field.offset);
+                    }
+                    break;
+                }
+                case TYPE_CODE::OPTIONAL: {
+                    // the optional is only engaged by a value of the expected JSON type
+                    const auto& value = j[field.name];
+                    void* optional = reinterpret_cast<void*>(reinterpret_cast<char*>(obj) + field.offset);
+                    if (!field.optional) {
+                        break;
+                    }
+                    if (has_struct_type(field)) {
+                        if (struct_metadata && value.is_object()) {
+                            ::jston::from_json(*struct_metadata, value, field.optional->emplace(optional));
+                        }
+                    } else if (detail::matches_basic_value(field.sub_type_code, value)) {
+                        detail::assign_basic_element(field.sub_type_code, value, field.optional->emplace(optional));
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error parsing field '" << field.name << "': " << e.what() << std::endl;
+        }
+    }
+}
+
+namespace detail {
+
+// report a field level conversion problem the same way the DOM based converters do
+inline void report_field_error(const field_metadata& field, const std::string& what) {
+    std::cerr << "Error parsing field '" << field.name << "': " << what << std::endl;
+}
+
+// number token produced by the scanner, the text is not converted until a field asks for it
+struct number_token {
+    std::string_view text;
+    bool is_integer;  // no fraction and no exponent
+    bool negative;
+};
+
+// significand and decimal exponent of a number token, value = significand * 10^exponent
+struct decimal_number {
+    uint64_t significand;
+    int exponent;
+    bool negative;
+};
+
+// split a number token already validated by the scanner, false when the significand has more than 19 digits
+inline bool split_decimal(std::string_view text, decimal_number& number) {
+    const char* cur = text.data();
+    const char* end = cur + text.size();
+    number = {0, 0, false};
+    if (*cur == '-') {
+        number.negative = true;
+        ++cur;
+    }
+    int digits = 0;  // significant digits accumulated, leading zeros do not count
+    for (; cur < end && *cur >= '0' && *cur <= '9'; ++cur) {
+        number.significand = number.significand * 10 + static_cast<uint64_t>(*cur - '0');
+        digits += number.significand != 0;
+    }
+    if (cur < end && *cur == '.') {
+        for (++cur; cur < end && *cur >= '0' && *cur <= '9'; ++cur) {
+            number.significand = number.significand * 10 + static_cast<uint64_t>(*cur - '0');
+            digits += number.significand != 0;
+            --number.exponent;
+        }
+    }
+    if (digits > 19) {
+        return false;
+    }
+    if (cur < end && (*cur == 'e' || *cur == 'E')) {
+        ++cur;
+        const bool negative_exponent = *cur == '-';
+        cur += *cur == '-' || *cur == '+';
+        int exponent = 0;
+        for (; cur < end && *cur >= '0' && *cur <= '9'; ++cur) {
+            exponent = exponent < 100000 ? exponent * 10 + (*cur - '0') : exponent;
+        }
+        number.exponent += negative_exponent ? -exponent : exponent;
+    }
+    return true;
+}
+
+// decimal exponent of the first significant digit of a number token, e.g. 2 for 123.4 and -3 for 0.00123e0
+// an out of range conversion is an underflow exactly when this is negative
+inline int leading_exponent(std::string_view text) {
+    const char* cur = text.data();
+    const char* end = cur + text.size();
+    cur += cur < end && *cur == '-';
+    int position = -1;  // exponent of the first significant digit, counted while the digits are read
+    bool significant = false;
+    for (; cur < end && *cur >= '0' && *cur <= '9'; ++cur) {
+        significant = significant || *cur != '0';
+        position += significant && position < 100000;
+    }
+    if (cur < end && *cur == '.') {
+        for (++cur; cur < end && *cur >= '0' && *cur <= '9' && !significant; ++cur) {
+            significant = *cur != '0';
+            position -= !significant && position > -100000;
+        }
+        for (; cur < end && *cur >= '0' && *cur <= '9'; ++cur) {
+        }
+    }
+    if (!significant) {
+        return 0;
+    }
+    if (cur < end && (*cur == 'e' || *cur == 'E')) {
+        ++cur;
+        const bool negative_exponent = cur < end && *cur == '-';
+        cur += cur < end && (*cur == '-' || *cur == '+');
+        int exponent = 0;
+        for (; cur < end && *cur >= '0' && *cur <= '9'; ++cur) {
+            exponent = exponent < 100000 ? exponent * 10 + (*cur - '0') : exponent;
+        }
+        position += negative_exponent ? -exponent : exponent;
+    }
+    return position;
+}
+
+// exact powers of ten of a floating point type, 10^0 .. 10^22 for double and 10^0 .. 10^10 for float
+template <typename V>
+struct exact_powers {
+    static constexpr int max_exponent = std::is_same<V, float>::value ? 10 : 22;
+    static constexpr uint64_t max_significand = uint64_t(1) << std::numeric_limits<V>::digits;
+    static constexpr V values[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+};
+
+// correctly rounded conversion of a number token to float or double, directly in the target type so that a float is
+// never rounded twice. significands and powers of ten that are both exact in V take Clinger's fast path (one exact
+// multiplication or division, hence one rounding); everything else goes to std::from_chars, an Eisel-Lemire style
+// parser in current standard libraries. a float out of its own range keeps the old conversion through double, and
+// a value too small for the type becomes zero of the same sign; only overflow fails
+template <typename V>
+inline bool parse_floating(std::string_view text, V& value) {
+#if FLT_EVAL_METHOD == 0
+    decimal_number number;
+    if (split_decimal(text, number)) {
+        if (number.significand == 0) {
+            value = number.negative ? -V(0) : V(0);
+            return true;
+        }
+        if (number.significand <= exact_powers<V>::max_significand &&
+            number.exponent >= -exact_powers<V>::max_exponent && number.exponent <= exact_powers<V>::max_exponent) {
+            V result = static_cast<V>(number.significand);
+            if (number.exponent < 0) {
+                result /= exact_powers<V>::values[-number.exponent];
+            } else {
+                result *= exact_powers<V>::values[number.exponent];
+            }
+            value = number.negative ? -result : result;
+            return true;
+        }
+    }
+#endif
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec == std::errc::result_out_of_range) {
+        double wide = 0;
+        if (std::is_same<V, float>::value &&
+            std::from_chars(text.data(), text.data() + text.size(), wide).ec == std::errc()) {
+            value = static_cast<V>(wide);
+            return true;
+        }
+        if (leading_exponent(text) < 0) {
+            value = text[0] == '-' ? -V(0) : V(0);
+            return true;
+        }
+    }
+    return result.ec == std::errc();
+}
+
+// integer type codes, the ones decoded by json_scanner::read_integer
+inline bool is_integer_code(TYPE_CODE type_code) {
+    switch (type_code) {
+        case TYPE_CODE::CHAR:
+        case TYPE_CODE::S_CHAR:
+        case TYPE_CODE::U_CHAR:
+        case TYPE_CODE::SHORT:
+        case TYPE_CODE::INT:
+        case TYPE_CODE::LONG:
+        case TYPE_CODE::LONG_LONG:
+        case TYPE_CODE::U_SHORT:
+        case TYPE_CODE::U_INT:
+        case TYPE_CODE::U_LONG:
+        case TYPE_CODE::U_LONG_LONG:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// eight bytes of text as a word with the first byte in the low bits
+inline uint64_t load_text_word(const char* text) {
+    uint64_t word;
+    memcpy(&word, text, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+// check that all eight bytes of a text word are ASCII digits
+inline bool is_eight_digits(uint64_t word) {
+    return ((word & 0xF0F0F0F0F0F0F0F0ULL) | (((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+           0x3333333333333333ULL;
+}
+
+// value of eight ASCII digits in a text word, combining digit pairs, then pairs of pairs, then the two halves
+inline uint32_t parse_eight_digits(uint64_t word) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 100 + (1000000ULL << 32);
+    const uint64_t mul2 = 1 + (10000ULL << 32);
+    word -= 0x3030303030303030ULL;
+    word = word * 10 + (word >> 8);
+    return static_cast<uint32_t>(((word & mask) * mul1 + ((word >> 16) & mask) * mul2) >> 32);
+}
+
+#if defined(__SSSE3__)
+// number of leading ASCII digits in 16 bytes of text
+inline unsigned count_sixteen_digits(__m128i chunk) {
+    const __m128i digits = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+    const __m128i outside = _mm_or_si128(_mm_cmplt_epi8(digits, _mm_setzero_si128()),
+                                         _mm_cmpgt_epi8(digits, _mm_set1_epi8(9)));
+    const unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(outside)) | 0x10000;
+    return static_cast<unsigned>(__builtin_ctz(bits));
+}
+
+// value of sixteen ASCII digits, multiply-adding neighbours into 2, 4 and 8 digit lanes
+inline uint64_t parse_sixteen_digits(__m128i chunk) {
+    const __m128i digits = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+    const __m128i tens = _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1);
+    const __m128i pairs = _mm_maddubs_epi16(digits, tens);
+    const __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    const __m128i packed = _mm_packs_epi32(quads, quads);
+    const __m128i octets = _mm_madd_epi16(packed, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+    const uint64_t high = static_cast<uint32_t>(_mm_cvtsi128_si32(octets));
+    const uint64_t low = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(octets, 4)));
+    return high * 100000000 + low;
+}
+#endif
+
+// parse a run of decimal digits, eight at a time (sixteen with SSSE3), returns the number of digits
+// the accumulated value is exact for up to 19 digits and wraps beyond that
+inline size_t parse_digits(const char*& cur, const char* end, uint64_t& value) {
+    const char* start = cur;
+    value = 0;
+#if defined(__SSSE3__)
+    if (end - cur >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+        if (count_sixteen_digits(chunk) == 16) {
+            value = parse_sixteen_digits(chunk);
+            cur += 16;
+        }
+    }
+#endif
+    while (end - cur >= 8) {
+        const uint64_t word = load_text_word(cur);
+        if (!is_eight_digits(word)) {
+            break;
+        }
+        value = value * 100000000 + parse_eight_digits(word);
+        cur += 8;
+    }
+    while (cur < end && *cur >= '0' && *cur <= '9') {
+        value = value * 10 + static_cast<uint64_t>(*cur - '0');
+        ++cur;
+    }
+    return static_cast<size_t>(cur - start);
+}
+
+// value of a 20 digit run, false when it does not fit in 64 bits
+inline bool parse_twenty_digits(const char* digits, uint64_t& value) {
+    value = 0;
+    for (int i = 0; i < 19; ++i) {
+        value = value * 10 + static_cast<uint64_t>(digits[i] - '0');
+    }
+    const uint64_t last = static_cast<uint64_t>(digits[19] - '0');
+    if (value > (std::numeric_limits<uint64_t>::max() - last) / 10) {
+        return false;
+    }
+    value = value * 10 + last;
+    return true;
+}
+
+// store a sign and magnitude into an integer slot, false when the value is outside the range of V
+template <typename V>
+inline bool store_in_range(void* dst, uint64_t magnitude, bool negative) {
+    if (negative && magnitude != 0) {
+        const uint64_t limit = static_cast<uint64_t>(-(static_cast<long long>(std::numeric_limits<V>::min()) + 1)) + 1;
+        if (!std::numeric_limits<V>::is_signed || magnitude > limit) {
+            return false;
+        }
+        *static_cast<V*>(dst) = static_cast<V>(-static_cast<long long>(magnitude - 1) - 1);
+        return true;
+    }
+    if (magnitude > static_cast<uint64_t>(std::numeric_limits<V>::max())) {
+        return false;
+    }
+    *static_cast<V*>(dst) = static_cast<V>(magnitude);
+    return true;
+}
+
+// store an integer into a slot of an integer type code, range checked against the slot width
+// char accepts both the signed and the unsigned byte range since its signedness is platform dependent
+inline bool store_integer(TYPE_CODE type_code, void* dst, uint64_t magnitude, bool negative) {
+    switch (type_code) {
+        case TYPE_CODE::CHAR:
+            return negative ? store_in_range<signed char>(dst, magnitude, negative)
+                            : store_in_range<unsigned char>(dst, magnitude, negative);
+        case TYPE_CODE::S_CHAR:
+            return store_in_range<signed char>(dst, magnitude, negative);
+        case TYPE_CODE::U_CHAR:
+            return store_in_range<unsigned char>(dst, magnitude, negative);
+        case TYPE_CODE::SHORT:
+            return store_in_range<short>(dst, magnitude, negative);
+        case TYPE_CODE::INT:
+            return store_in_range<int>(dst, magnitude, negative);
+        case TYPE_CODE::LONG:
+            return store_in_range<long>(dst, magnitude, negative);
+        case TYPE_CODE::LONG_LONG:
+            return store_in_range<long long>(dst, magnitude, negative);
+        case TYPE_CODE::U_SHORT:
+            return store_in_range<unsigned short>(dst, magnitude, negative);
+        case TYPE_CODE::U_INT:
+            return store_in_range<unsigned int>(dst, magnitude, negative);
+        case TYPE_CODE::U_LONG:
+            return store_in_range<unsigned long>(dst, magnitude, negative);
+        case TYPE_CODE::U_LONG_LONG:
+            return store_in_range<unsigned long long>(dst, magnitude, negative);
+        default:
+            return false;
+    }
+}
+
+// convert a number token and store it, returns false if the token cannot be represented. integer slots are range
+// checked against their width; a number with a fraction or an exponent is only stored there when it is integral
+inline bool store_number_token(TYPE_CODE type_code, void* dst, const number_token& number) {
+    // floating point fields are parsed in their own type
+    if (type_code == TYPE_CODE::FLOAT) {
+        return parse_floating(number.text, *static_cast<float*>(dst));
+    }
+    if (type_code == TYPE_CODE::DOUBLE) {
+        return parse_floating(number.text, *static_cast<double*>(dst));
+    }
+    if (number.is_integer) {
+        // integers beyond 64 bits do not fit any slot
+        uint64_t magnitude = 0;
+        const char* first = number.text.data() + number.negative;
+        const char* last = number.text.data() + number.text.size();
+        return std::from_chars(first, last, magnitude).ec == std::errc() &&
+               store_integer(type_code, dst, magnitude, number.negative);
+    }
+    double value = 0;
+    if (!parse_floating(number.text, value) || value != std::trunc(value) || std::fabs(value) >= 0x1p64) {
+        return false;
+    }
+    return store_integer(type_code, dst, static_cast<uint64_t>(std::fabs(value)), value < 0);
+}
+
+// outcome of json_scanner::read_integer
+enum class integer_status : uint8_t {
+    STORED,        // the value was written to the slot
+    OUT_OF_RANGE,  // the number was consumed but does not fit the slot, which is left untouched
+    NOT_INTEGER    // the number has a fraction or an exponent and was not consumed
+};
+
+#if defined(__SSE2__)
+// bit masks of a 64-byte block of JSON text, bit i describes byte i
+struct block_masks {
+    uint64_t quote = 0;
+    uint64_t backslash = 0;
+    uint64_t open = 0;   // { and [
+    uint64_t close = 0;  // } and ]
+};
+
+// classify 64 bytes of text with four 16-byte compares per character class
+inline block_masks classify_block(const char* block) {
+    block_masks masks;
+    for (int i = 0; i < 4; ++i) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+        auto bits = [&](char c, char alternative) {
+            const __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(c)),
+                                                 _mm_cmpeq_epi8(chunk, _mm_set1_epi8(alternative)));
+            return static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(matches))) << (16 * i);
+        };
+        masks.quote |= bits('"', '"');
+        masks.backslash |= bits('\\', '\\');
+        masks.open |= bits('{', '[');
+        masks.close |= bits('}', ']');
+    }
+    return masks;
+}
+
+// bytes escaped by a backslash, runs of backslashes escape each other in pairs. prev_escaped carries whether the
+// first byte of the next block is escaped
+inline uint64_t find_escaped(uint64_t backslash, uint64_t& prev_escaped) {
+    backslash &= ~prev_escaped;
+    const uint64_t follows_escape = backslash << 1 | prev_escaped;
+    const uint64_t even_bits = 0x5555555555555555ULL;
+    const uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+    const uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+    prev_escaped = sequences_starting_on_even_bits < backslash;  // carry out of the addition
+    const uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+    return (even_bits ^ invert_mask) & follows_escape;
+}
+
+// bit i is the xor of bits 0..i, which turns the positions of unescaped quotes into a mask of string contents
+inline uint64_t prefix_xor(uint64_t bits) {
+#if defined(__PCLMUL__)
+    const __m128i product =
+        _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(bits)), _mm_set1_epi8(-1), 0);
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+#else
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+#endif
+}
+
+// position of the first quote, backslash or control character in the 16 bytes at text, 16 if there is none
+inline unsigned find_string_special(const char* text) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text));
+    const __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F));
+    const __m128i special = _mm_or_si128(
+        control, _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))));
+    return static_cast<unsigned>(__builtin_ctz(static_cast<unsigned>(_mm_movemask_epi8(special)) | 0x10000));
+}
+#endif
+
+// a key of a struct as it appears in JSON text, quoted; its first 16 bytes are also kept as two words with a mask
+// so that the scanner can check for it with one wide compare
+struct expected_key {
+    std::string quoted;
+    uint64_t head[2] = {0, 0};
+    uint64_t mask[2] = {0, 0};
+
+    explicit expected_key(const char* name) : quoted(std::string("\"") + name + "\"") {
+        unsigned char bytes[16] = {};
+        unsigned char bits[16] = {};
+        for (size_t i = 0; i < quoted.size() && i < 16; ++i) {
+            bytes[i] = static_cast<unsigned char>(quoted[i]);
+            bits[i] = 0xFF;
+        }
+        memcpy(head, bytes, sizeof(head));
+        memcpy(mask, bits, sizeof(mask));
+    }
+};
+
+// decoding index of the fields of a struct, built once per type and shared by all threads: the quoted keys for the
+// speculative compare, an open addressing hash table of the names for keys that miss it, and the key order last seen
+// in the input. next(i) is the field that followed field i (next(size()) the first field of an object); it starts out
+// as registration order, which is what jston itself writes, and is corrected whenever the input disagrees. the order
+// is only a guess, so it is kept in relaxed atomics and whatever value a thread reads is safe
+class key_index {
+private:
+    field_table table;
+    std::vector<expected_key> keys;
+    std::unique_ptr<std::atomic<uint32_t>[]> successor;
+    std::vector<uint32_t> slots;  // field index + 1 of the name in each slot, 0 for an empty slot
+
+    // FNV-1a
+    static size_t hash(std::string_view name) {
+        uint64_t h = 14695981039346656037ULL;
+        for (char c : name) {
+            h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+        }
+        return static_cast<size_t>(h);
+    }
+
+public:
+    explicit key_index(field_table fields) : table(fields), successor(new std::atomic<uint32_t>[fields.size() + 1]) {
+        size_t capacity = 4;
+        while (capacity < 2 * fields.size()) {
+            capacity *= 2;
+        }
+        slots.assign(capacity, 0);
+        keys.reserve(fields.size());
+        for (size_t i = 0; i < fields.size(); ++i) {
+            keys.emplace_back(fields[i].name);
+            successor[i].store(static_cast<uint32_t>(i + 1), std::memory_order_relaxed);
+            // a repeated name keeps the first field, like a linear search would
+            size_t slot = hash(fields[i].name) & (capacity - 1);
+            while (slots[slot] != 0) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            slots[slot] = static_cast<uint32_t>(i + 1);
+        }
+        successor[fields.size()].store(0, std::memory_order_relaxed);
+    }
+
+    key_index(const key_index&) = delete;
+    key_index& operator=(const key_index&) = delete;
+
+    field_table fields() const {
+        return table;
+    }
+    size_t size() const {
+        return table.size();
+    }
+    const field_metadata& operator[](size_t index) const {
+        return table[index];
+    }
+    const expected_key& key(size_t index) const {
+        return keys[index];
+    }
+
+    // index of the field with the given name, size() when there is none
+    size_t find(std::string_view name) const {
+        const size_t mask = slots.size() - 1;
+        for (size_t slot = hash(name) & mask;; slot = (slot + 1) & mask) {
+            const uint32_t entry = slots[slot];
+            if (entry == 0) {
+                return table.size();
+            }
+            const std::string& quoted = keys[entry - 1].quoted;
+            if (quoted.size() == name.size() + 2 && memcmp(quoted.data() + 1, name.data(), name.size()) == 0) {
+                return entry - 1;
+            }
+        }
+    }
+
+    // field expected to follow the field previous (size() for the start of an object), may be out of range
+    size_t next(size_t previous) const {
+        return successor[previous].load(std::memory_order_relaxed);
+    }
+
+    // record that the field index followed the field previous in the input
+    void follow(size_t previous, size_t index) const {
+        successor[previous].store(static_cast<uint32_t>(index), std::memory_order_relaxed);
+    }
+};
+
+// key index of a field table that has no compile-time table behind it (runtime registration, legacy macros), cached
+// per thread by the address of the table; registered metadata is never freed, so the address identifies it
+inline const key_index& key_index_for(field_table fields) {
+    thread_local std::unordered_map<const field_metadata*, std::unique_ptr<key_index>> indexes;
+    std::unique_ptr<key_index>& index = indexes[fields.fields];
+    if (!index) {
+        index.reset(new key_index(fields));
+    }
+    return *index;
+}
+
+// key index of a struct type: built once from the compile-time table of a type registered with register_json_struct,
+// otherwise taken from the per-thread cache; null while the type is unknown
+template <typename T>
+const key_index* find_key_index() {
+    if constexpr (struct_info<T>::is_registered) {
+        static const key_index index(fields_of<T>());
+        return &index;
+    } else {
+        const std::vector<field_metadata>* metadata = metadata_of<T>();
+        return metadata ? &key_index_for(*metadata) : nullptr;
+    }
+}
+
+// key index of a struct type, throws if the type has not been registered
+template <typename T>
+const key_index& key_index_of() {
+    if (const key_index* index = find_key_index<T>()) {
+        return *index;
+    }
+    throw std::runtime_error(std::string("No metadata found for type: ") + typeid(T).name());
+}
+
+// key index of the nested struct / struct array element type of a field, or null
+inline const key_index* nested_index(const field_metadata& field) {
+    if (field.struct_index) {
+        return field.struct_index();
+    }
+    const field_table nested = nested_table(field);
+    return nested.fields ? &key_index_for(nested) : nullptr;
+}
+
+// forward-only structural scanner over JSON text
+// values that are not needed can be skipped with a bracket/quote-aware scan that never decodes strings or numbers
+class json_scanner {
+private:
+    const char* begin;
+    const char* cur;
+    const char* end;
+    size_t base;  // offset of begin in the whole input, for error messages
+    bool strict = false;  // skipped values are checked like validate does instead of only scanned structurally
+
+    void skip_ws() {
+        while (cur < end && (*cur == ' ' || *cur == '\n' || *cur == '\r' || *cur == '\t')) {
+            ++cur;
+        }
+    }
+
+    static bool is_delimiter(char c) {
+        return c == ',' || c == '}' || c == ']' || c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    void expect_literal(const char* literal, size_t length) {
+        if (static_cast<size_t>(end - cur) < length || memcmp(cur, literal, length) != 0) {
+            fail("invalid literal");
+        }
+        cur += length;
+    }
+
+    static void append_utf8(std::string& out, uint32_t code_point) {
+        if (code_point < 0x80) {
+            out += static_cast<char>(code_point);
+        } else if (code_point < 0x800) {
+            out += static_cast<char>(0xC0 | (code_point >> 6));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        } else if (code_point < 0x10000) {
+            out += static_cast<char>(0xE0 | (code_point >> 12));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code_point >> 18));
+            out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+    }
+
+    uint32_t read_hex4() {
+        if (end - cur < 4) {
+            fail("truncated unicode escape");
+        }
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = *cur++;
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                value |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                value |= c - 'A' + 10;
+            } else {
+                fail("invalid unicode escape");
+            }
+        }
+        return value;
+    }
+
+    // skip until the containers opened so far are closed again
+    void skip_nested(size_t depth) {
+        if (const char* problem = try_skip_nested(depth)) {
+            fail(problem);
+        }
+    }
+
+public:
+    json_scanner(const char* begin, const char* end, size_t base = 0)
+        : begin(begin), cur(begin), end(end), base(base) {}
+
+    // skip until the containers opened so far are closed again, returns what is missing when the input ends first
+    const char* try_skip_nested(size_t depth) {
+#if defined(__SSE2__)
+        // the text is classified 64 bytes at a time: unescaped quotes delimit strings, brackets outside strings change
+        // the depth, and a block without enough closing brackets to bring the depth to zero is passed over whole
+        uint64_t prev_escaped = 0;
+        uint64_t prev_in_string = 0;
+        char padded[64];
+        while (cur < end) {
+            const size_t available = std::min<size_t>(64, static_cast<size_t>(end - cur));
+            const char* block = cur;
+            if (available < 64) {
+                memset(padded, ' ', sizeof(padded));
+                memcpy(padded, cur, available);
+                block = padded;
+            }
+            const block_masks masks = classify_block(block);
+            const uint64_t quote = masks.quote & ~find_escaped(masks.backslash, prev_escaped);
+            const uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+            prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+            const uint64_t open = masks.open & ~in_string;
+            const uint64_t close = masks.close & ~in_string;
+            if (static_cast<size_t>(__builtin_popcountll(close)) < depth) {
+                depth += static_cast<size_t>(__builtin_popcountll(open));
+                depth -= static_cast<size_t>(__builtin_popcountll(close));
+                cur += available;
+                continue;
+            }
+            for (uint64_t brackets = open | close; brackets != 0; brackets &= brackets - 1) {
+                const uint64_t bit = brackets & (0 - brackets);
+                if ((open & bit) != 0) {
+                    ++depth;
+                } else if (--depth == 0) {
+                    cur += __builtin_ctzll(bit) + 1;
+                    return nullptr;
+                }
+            }
+            cur += available;
+        }
+        return prev_in_string ? "unterminated string" : "unterminated object or array";
+#else
+        while (depth > 0) {
+            const char* next = cur;
+            while (next < end && *next != '"' && *next != '{' && *next != '[' && *next != '}' && *next != ']') {
+                ++next;
+            }
+            if (next == end) {
+                cur = end;
+                return "unterminated object or array";
+            }
+            cur = next;
+            switch (*cur) {
+                case '"':
+                    if (!try_skip_string()) {
+                        return "unterminated string";
+                    }
+                    continue;
+                case '{':
+                case '[':
+                    ++depth;
+                    break;
+                default:
+                    --depth;
+                    break;
+            }
+            ++cur;
+        }
+#endif
+        return nullptr;
+    }
+
+    // next significant character without consuming it, '\0' at the end of input
+    char peek() {
+        skip_ws();
+        return cur < end ? *cur : '\0';
+    }
+
+    bool at_end() {
+        skip_ws();
+        return cur == end;
+    }
+
+    bool consume(char c) {
+        if (peek() == c && cur < end) {
+            ++cur;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) {
+            fail(std::string("expected '") + c + "'");
+        }
+    }
+
+    // position of the scanner in the input
+    size_t offset() const {
+        return base + static_cast<size_t>(cur - begin);
+    }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("syntax error at offset " + std::to_string(offset()) + ": " + what);
+    }
+
+    // skip a complete value of any type without decoding it
+    // a strict scanner checks the syntax of the value (see check_value); otherwise only the structure is scanned, so
+    // malformed literals, numbers and escapes inside the value go unnoticed
+    void skip_value() {
+        if (strict) {
+            check_value();
+            return;
+        }
+        scan_value();
+    }
+
+    // check the syntax of every value that is skipped from now on, used by decodes that read the whole text
+    void set_strict(bool on) {
+        strict = on;
+    }
+
+    // skip a complete value by its structure alone, quotes and brackets are matched but nothing else is checked
+    void scan_value() {
+        switch (peek()) {
+            case '"':
+                skip_string();
+                return;
+            case '{':
+            case '[':
+                ++cur;
+                skip_nested(1);
+                return;
+            default: {
+                const char* start = cur;
+                while (cur < end && !is_delimiter(*cur)) {
+                    ++cur;
+                }
+                if (cur == start) {
+                    fail("unexpected character");
+                }
+                return;
+            }
+        }
+    }
+
+    // number of members of the object starting at the current position, which is left unchanged
+    size_t count_members() {
+        const char* start = cur;
+        size_t count = 0;
+        expect('{');
+        if (!consume('}')) {
+            do {
+                if (peek() != '"') {
+                    fail("expected string");
+                }
+                skip_string();
+                expect(':');
+                scan_value();
+                ++count;
+            } while (consume(','));
+        }
+        cur = start;
+        return count;
+    }
+
+    // skip the remaining members of the object the scanner is currently inside, including its closing brace
+    void skip_object_rest() {
+        skip_nested(1);
+    }
+
+    // skip a string value, the scanner must be positioned on its opening quote
+    void skip_string() {
+        if (!try_skip_string()) {
+            fail("unterminated string");
+        }
+    }
+
+    // skip a string value like skip_string, false when the input ends first
+    bool try_skip_string() {
+        ++cur;
+        for (;;) {
+            const char* quote = static_cast<const char*>(memchr(cur, '"', end - cur));
+            if (!quote) {
+                cur = end;
+                return false;
+            }
+            // an odd number of backslashes in front of the quote means it is escaped
+            const char* backslash = quote;
+            while (backslash > cur && backslash[-1] == '\\') {
+                --backslash;
+            }
+            cur = quote + 1;
+            if (((quote - backslash) & 1) == 0) {
+                return true;
+            }
+        }
+    }
+
+    // consume the key if the input continues with exactly its quoted bytes; keys of up to 14 characters are checked
+    // with one masked 16-byte compare when that much input is left
+    bool consume_key(const expected_key& key) {
+        skip_ws();
+        const size_t length = key.quoted.size();
+        if (length <= 16 && end - cur >= 16) {
+            uint64_t text[2];
+            memcpy(text, cur, sizeof(text));
+            if ((((text[0] ^ key.head[0]) & key.mask[0]) | ((text[1] ^ key.head[1]) & key.mask[1])) != 0) {
+                return false;
+            }
+        } else if (static_cast<size_t>(end - cur) < length || memcmp(cur, key.quoted.data(), length) != 0) {
+            return false;
+        }
+        cur += length;
+        return true;
+    }
+
+    // read a string value, returns a view into the input when no escapes are present, otherwise decodes into scratch
+    std::string_view read_string(std::string& scratch) {
+        if (peek() != '"') {
+            fail("expected string");
+        }
+        const char* start = ++cur;
+#if defined(__SSE2__)
+        while (end - cur >= 16) {
+            const unsigned at = find_string_special(cur);
+            cur += at;
+            if (at < 16) {
+                break;
+            }
+        }
+#endif
+        while (cur < end && *cur != '"' && *cur != '\\' && static_cast<unsigned char>(*cur) >= 0x20) {
+            ++cur;
+        }
+        if (cur < end && *cur == '"') {
+            return std::string_view(start, static_cast<size_t>(cur++ - start));
+        }
+
+        scratch.assign(start, cur);
+        while (cur < end) {
+            const char c = *cur++;
+            if (c == '"') {
+                return scratch;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                fail("control character in string");
+            }
+            if (c != '\\') {
+                scratch += c;
+                continue;
+            }
+            if (cur == end) {
+                break;
+            }
+            switch (*cur++) {
+                case '"':
+                    scratch += '"';
+                    break;
+                case '\\':
+                    scratch += '\\';
+                    break;
+                case '/':
+                    scratch += '/';
+                    break;
+                case 'b':
+                    scratch += '\b';
+                    break;
+                case 'f':
+                    scratch += '\f';
+                    break;
+                case 'n':
+                    scratch += '\n';
+                    break;
+                case 'r':
+                    scratch += '\r';
+                    break;
+                case 't':
+                    scratch += '\t';
+                    break;
+                case 'u': {
+                    uint32_t code_point = read_hex4();
+                    if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+                        // surrogate pair
+                        if (end - cur < 2 || cur[0] != '\\' || cur[1] != 'u') {
+                            fail("invalid surrogate pair");
+                        }
+                        cur += 2;
+                        const uint32_t low = read_hex4();
+                        if (low < 0xDC00 || low > 0xDFFF) {
+                            fail("invalid surrogate pair");
+                        }
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(scratch, code_point);
+                    break;
+                }
+                default:
+                    fail("invalid escape sequence");
+            }
+        }
+        fail("unterminated string");
+    }
+
+    // check a string value without decoding it: returns the text between the quotes and sets length to the size of
+    // the decoded string in bytes
+    std::string_view scan_string(size_t& length) {
+        if (peek() != '"') {
+            fail("expected string");
+        }
+        const char* start = ++cur;
+#if defined(__SSE2__)
+        while (end - cur >= 16) {
+            const unsigned at = find_string_special(cur);
+            cur += at;
+            if (at < 16) {
+                break;
+            }
+        }
+#endif
+        length = static_cast<size_t>(cur - start);
+        while (cur < end) {
+            const char c = *cur++;
+            if (c == '"') {
+                return std::string_view(start, static_cast<size_t>(cur - 1 - start));
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                fail("control character in string");
+            }
+            ++length;
+            if (c != '\\') {
+                continue;
+            }
+            if (cur == end) {
+                break;
+            }
+            switch (*cur++) {
+                case '"':
+                case '\\':
+                case '/':
+                case 'b':
+                case 'f':
+                case 'n':
+                case 'r':
+                case 't':
+                    break;
+                case 'u': {
+                    uint32_t code_point = read_hex4();
+                    if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+                        if (end - cur < 2 || cur[0] != '\\' || cur[1] != 'u') {
+                            fail("invalid surrogate pair");
+                        }
+                        cur += 2;
+                        const uint32_t low = read_hex4();
+                        if (low < 0xDC00 || low > 0xDFFF) {
+                            fail("invalid surrogate pair");
+                        }
+                        code_point = 0x10000;
+                    }
+                    // utf-8 length of the code point, one byte is already counted
+                    length += (code_point >= 0x80) + (code_point >= 0x800) + (code_point >= 0x10000);
+                    break;
+                }
+                default:
+                    fail("invalid escape sequence");
+            }
+        }
+        fail("unterminated string");
+    }
+
+    // read and validate a number token without converting it
+    number_token read_number() {
+        skip_ws();
+        number_token number{std::string_view(), true, false};
+        const char* start = cur;
+        if (cur < end && *cur == '-') {
+            number.negative = true;
+            ++cur;
+        }
+        if (cur < end && *cur == '0') {
+            ++cur;
+        } else if (cur < end && *cur >= '1' && *cur <= '9') {
+            while (cur < end && *cur >= '0' && *cur <= '9') {
+                ++cur;
+            }
+        } else {
+            fail("invalid number");
+        }
+        if (cur < end && *cur == '.') {
+            number.is_integer = false;
+            ++cur;
+            if (cur == end || *cur < '0' || *cur > '9') {
+                fail("invalid number");
+            }
+            while (cur < end && *cur >= '0' && *cur <= '9') {
+                ++cur;
+            }
+        }
+        if (cur < end && (*cur == 'e' || *cur == 'E')) {
+            number.is_integer = false;
+            ++cur;
+            if (cur < end && (*cur == '+' || *cur == '-')) {
+                ++cur;
+            }
+            if (cur == end || *cur < '0' || *cur > '9') {
+                fail("invalid number");
+            }
+            while (cur < end && *cur >= '0' && *cur <= '9') {
+                ++cur;
+            }
+        }
+        number.text = std::string_view(start, static_cast<size_t>(cur - start));
+        return number;
+    }
+
+    bool read_bool() {
+        if (peek() == 't') {
+            expect_literal("true", 4);
+            return true;
+        }
+        expect_literal("false", 5);
+        return false;
+    }
+
+    // read an integer straight into a slot of an integer type code, with the range check done in the same pass
+    integer_status read_integer(TYPE_CODE type_code, void* dst) {
+        skip_ws();
+        const char* start = cur;
+        const bool negative = cur < end && *cur == '-';
+        cur += negative;
+        uint64_t magnitude = 0;
+        size_t digits = 1;
+        if (cur < end && *cur == '0') {
+            ++cur;
+        } else if (cur < end && *cur >= '1' && *cur <= '9') {
+            digits = parse_digits(cur, end, magnitude);
+        } else {
+            fail("invalid number");
+        }
+        if (cur < end && (*cur == '.' || *cur == 'e' || *cur == 'E')) {
+            cur = start;
+            return integer_status::NOT_INTEGER;
+        }
+        if (digits > 20 || (digits == 20 && !parse_twenty_digits(cur - 20, magnitude))) {
+            return integer_status::OUT_OF_RANGE;
+        }
+        return store_integer(type_code, dst, magnitude, negative) ? integer_status::STORED
+                                                                   : integer_status::OUT_OF_RANGE;
+    }
+
+    // consume a null literal if present
+    bool consume_null() {
+        if (peek() != 'n') {
+            return false;
+        }
+        expect_literal("null", 4);
+        return true;
+    }
+
+    // check the syntax of a complete value of any type without decoding it; unlike skip_value every string, number
+    // and literal is checked. containers are tracked in a fixed bit stack, so nesting is limited to 1024 levels
+    void check_value() {
+        uint64_t objects[16] = {};  // one bit per open container, set for objects
+        size_t depth = 0;
+        size_t length = 0;
+        for (;;) {
+            const char c = peek();
+            if (c == '{' || c == '[') {
+                if (depth == 1024) {
+                    fail("nesting too deep");
+                }
+                ++cur;
+                const bool object = c == '{';
+                objects[depth / 64] = (objects[depth / 64] & ~(uint64_t(1) << (depth % 64))) |
+                                      (uint64_t(object) << (depth % 64));
+                if (!consume(object ? '}' : ']')) {
+                    ++depth;
+                    if (object) {
+                        scan_string(length);
+                        expect(':');
+                    }
+                    continue;
+                }
+            } else if (c == '"') {
+                scan_string(length);
+            } else if (c == 't' || c == 'f') {
+                read_bool();
+            } else if (c == 'n') {
+                consume_null();
+            } else if (c == '-' || (c >= '0' && c <= '9')) {
+                read_number();
+            } else {
+                fail("unexpected character");
+            }
+            // the value is complete, close the containers it ends
+            for (;;) {
+                if (depth == 0) {
+                    return;
+                }
+                const bool object = (objects[(depth - 1) / 64] >> ((depth - 1) % 64)) & 1;
+                if (consume(',')) {
+                    if (object) {
+                        scan_string(length);
+                        expect(':');
+                    }
+                    break;
+                }
+                expect(object ? '}' : ']');
+                --depth;
+            }
+        }
+    }
+};
+
+// read the integer value of an enum, false when it is not integral or does not fit the underlying type of the enum
+inline bool read_enum_value(const enum_ops& ops, json_scanner& in, long long& raw) {
+    const integer_status status = in.read_integer(TYPE_CODE::LONG_LONG, &raw);
+    if (status == integer_status::NOT_INTEGER && !store_number_token(TYPE_CODE::LONG_LONG, &raw, in.read_number())) {
+        return false;
+    }
+    return status != integer_status::OUT_OF_RANGE && ops.in_range(raw);
+}
+
+// forward declaration of the recursive struct decoder
+inline void decode_struct(const key_index& metadata, json_scanner& in, void* obj, const field_mask* mask,
+                          bool stop_early);
+
+// decode one element of a basic type array, elements of the wrong JSON type are skipped like the DOM path does
+inline void decode_array_element(TYPE_CODE sub_type_code, json_scanner& in, void* dst) {
+    const char c = in.peek();
+    if (sub_type_code == TYPE_CODE::BOOL) {
+        if (c == 't' || c == 'f') {
+            *static_cast<bool*>(dst) = in.read_bool();
+        } else {
+            in.skip_value();
+        }
+        return;
+    }
+    if (c != '-' && (c < '0' || c > '9')) {
+        in.skip_value();
+        return;
+    }
+    // integers that do not fit the element width are skipped as well, and so are non-integral numbers
+    if (is_integer_code(sub_type_code) && in.read_integer(sub_type_code, dst) != integer_status::NOT_INTEGER) {
+        return;
+    }
+    store_number_token(sub_type_code, dst, in.read_number());
+}
+
+// decode nested JSON arrays into a multi-dimensional array, elements beyond an extent are skipped
+inline void decode_shaped(const field_metadata& field, const size_t* extents, size_t rank, json_scanner& in,
+                          char* data, const key_index* struct_metadata, const field_mask* mask) {
+    if (in.peek() != '[') {
+        in.skip_value();
+        return;
+    }
+    in.expect('[');
+    if (in.consume(']')) {
+        return;
+    }
+    const size_t stride = shaped_stride(extents, rank, field.element_size);
+    size_t i = 0;
+    do {
+        char* element = data + i * stride;
+        if (i >= extents[0]) {
+            in.skip_value();
+        } else if (rank > 1) {
+            decode_shaped(field, extents + 1, rank - 1, in, element, struct_metadata, mask);
+        } else if (struct_metadata && in.peek() == '{') {
+            decode_struct(*struct_metadata, in, element, mask, false);
+        } else if (!has_struct_type(field) && field.sub_type_code != TYPE_CODE::UNKNOWN) {
+            decode_array_element(field.sub_type_code, in, element);
+        } else {
+            in.skip_value();
+        }
+        ++i;
+    } while (in.consume(','));
+    in.expect(']');
+}
+
+// decode the JSON value at the scanner position into one field
+inline void decode_field(const field_metadata& field, json_scanner& in, void* obj, const field_mask* mask) {
+    char* field_ptr = static_cast<char*>(obj) + field.offset;
+
+    // null clears an optional and leaves other fields untouched
+    if (in.consume_null()) {
+        if (field.type_code == TYPE_CODE::OPTIONAL && field.optional) {
+            field.optional->reset(field_ptr);
+        }
+        return;
+    }
+    JSTON_STATS_COUNT(fields_decoded);
+
+    switch (field.type_code) {
+        case TYPE_CODE::CHAR:
+        case TYPE_CODE::S_CHAR:
+        case TYPE_CODE::U_CHAR:
+        case TYPE_CODE::SHORT:
+        case TYPE_CODE::INT:
+        case TYPE_CODE::LONG:
+        case TYPE_CODE::LONG_LONG:
+        case TYPE_CODE::U_SHORT:
+        case TYPE_CODE::U_INT:
+        case TYPE_CODE::U_LONG:
+        case TYPE_CODE::U_LONG_LONG:
+        case TYPE_CODE::FLOAT:
+        case TYPE_CODE::DOUBLE: {
+            const char c = in.peek();
+            if (c != '-' && (c < '0' || c > '9')) {
+                in.skip_value();
+                report_field_error(field, "value is not a number");
+                break;
+            }
+            const integer_status status = is_integer_code(field.type_code)
+                                              ? in.read_integer(field.type_code, field_ptr)
+                                              : integer_status::NOT_INTEGER;
+            if (status == integer_status::OUT_OF_RANGE ||
+                (status == integer_status::NOT_INTEGER &&
+                 !store_number_token(field.type_code, field_ptr, in.read_number()))) {
+                report_field_error(field, "number out of range");
+            }
+            break;
+        }
+        case TYPE_CODE::BOOL: {
+            const char c = in.peek();
+            if (c != 't' && c != 'f') {
+                in.skip_value();
+                report_field_error(field, "value is not a boolean");
+                break;
+            }
+            *reinterpret_cast<bool*>(field_ptr) = in.read_bool();
+            break;
+        }
+        case TYPE_CODE::STRING: {
+            if (in.peek() != '"') {
+                in.skip_value();
+                report_field_error(field, "value is not a string");
+                break;
+            }
+            std::string scratch;
+            const std::string_view value = in.read_string(scratch);
+            // copy with truncation and zero padding, matching the strncpy based DOM path
+            if (field.size > 0) {
+                const size_t length = std::min(value.size(), field.size - 1);
+                memcpy(field_ptr, value.data(), length);
+                memset(field_ptr + length, 0, field.size - length);
+            }
+            break;
+        }
+        case TYPE_CODE::STD_STRING: {
+            if (in.peek() != '"') {
+                in.skip_value();
+                report_field_error(field, "value is not a string");
+                break;
+            }
+            // escaped strings are decoded straight into the member, reusing its capacity
+            std::string& target = *reinterpret_cast<std::string*>(field_ptr);
+            const std::string_view value = in.read_string(target);
+            if (value.data() != target.data()) {
+                target.assign(value.data(), value.size());
+            }
+            break;
+        }
+        case TYPE_CODE::STRING_VIEW: {
+            if (in.peek() != '"') {
+                in.skip_value();
+                report_field_error(field, "value is not a string");
+                break;
+            }
+            // zero copy: the view points into the input text, strings with escapes have no such representation
+            std::string scratch;
+            const std::string_view value = in.read_string(scratch);
+            if (value.data() == scratch.data()) {
+                report_field_error(field, "escaped string cannot be decoded into std::string_view");
+                break;
+            }
+            *reinterpret_cast<std::string_view*>(field_ptr) = value;
+            break;
+        }
+        case TYPE_CODE::POINTER: {
+            // explicitly set pointer types to null during deserialization
+            in.skip_value();
+            *reinterpret_cast<void**>(field_ptr) = nullptr;
+            break;
+        }
+        case TYPE_CODE::STRUCT: {
+            const key_index* struct_metadata = nullptr;
+            if (has_struct_type(field)) {
+                struct_metadata = nested_index(field);
+            }
+            if (!struct_metadata || in.peek() != '{') {
+                in.skip_value();
+                break;
+            }
+            decode_struct(*struct_metadata, in, field_ptr, mask, false);
+            break;
+        }
+        case TYPE_CODE::ARRAY: {
+            if (field.bytes_format != BYTES_FORMAT::ARRAY && in.peek() == '"') {
+                std::string scratch;
+                const std::string_view text = in.read_string(scratch);
+                try {
+                    set_live_length(field, obj, decode_bytes(field.bytes_format, text, field_ptr, field.size));
+                } catch (const std::exception& e) {
+                    report_field_error(field, e.what());
+                }
+                break;
+            }
+            if (in.peek() != '[') {
+                in.skip_value();
+                break;
+            }
+            const key_index* struct_metadata = nullptr;
+            if (has_struct_type(field)) {
+                struct_metadata = nested_index(field);
+            }
+            const bool is_struct_array = has_struct_type(field);
+            const size_t element_size = field.element_size;
+            const size_t capacity = element_size > 0 ? field.size / element_size : 0;
+            if (field.rank > 1 && field.extents) {
+                decode_shaped(field, field.extents, field.rank, in, field_ptr, struct_metadata, mask);
+                break;
+            }
+
+            in.expect('[');
+            size_t i = 0;
+            if (!in.consume(']')) {
+                do {
+                    if (i < capacity && is_struct_array && struct_metadata && in.peek() == '{') {
+                        decode_struct(*struct_metadata, in, field_ptr + i * element_size, mask, false);
+                    } else if (i < capacity && !is_struct_array && field.sub_type_code != TYPE_CODE::UNKNOWN) {
+                        decode_array_element(field.sub_type_code, in, field_ptr + i * element_size);
+                    } else {
+                        // elements beyond the array capacity or of unknown type are skipped
+                        in.skip_value();
+                    }
+                    ++i;
+                } while (in.consume(','));
+                in.expect(']');
+            }
+            set_live_length(field, obj, i);
+            break;
+        }
+        case TYPE_CODE::VECTOR: {
+            const key_index* struct_metadata = nullptr;
+            if (has_struct_type(field)) {
+                struct_metadata = nested_index(field);
+            }
+            const bool decodable =
+                field.sequence && (has_struct_type(field) ? struct_metadata != nullptr
+                                                          : field.sub_type_code != TYPE_CODE::UNKNOWN);
+            if (!decodable || in.peek() != '[') {
+                in.skip_value();
+                break;
+            }
+            // elements already in the vector are decoded in place, it only grows when the JSON array is longer
+            const sequence_ops& ops = *field.sequence;
+            in.expect('[');
+            size_t count = 0;
+            if (!in.consume(']')) {
+                do {
+                    if (count == ops.size(field_ptr)) {
+                        ops.resize(field_ptr, count + 1);
+                    }
+                    char* data = static_cast<char*>(ops.mutable_data(field_ptr));
+                    if (struct_metadata) {
+                        if (in.peek() == '{') {
+                            decode_struct(*struct_metadata, in, data + count * field.element_size, mask, false);
+                        } else {
+                            in.skip_value();
+                        }
+                    } else if (!data) {
+                        // std::vector<bool> has no addressable elements
+                        bool value = ops.get_bool(field_ptr, count);
+                        decode_array_element(TYPE_CODE::BOOL, in, &value);
+                        ops.set_bool(field_ptr, count, value);
+                    } else {
+                        decode_array_element(field.sub_type_code, in, data + count * field.element_size);
+                    }
+                    ++count;
+                } while (in.consume(','));
+                in.expect(']');
+            }
+            ops.resize(field_ptr, count);
+            break;
+        }
+        case TYPE_CODE::MAP: {
+            const key_index* struct_metadata = nullptr;
+            if (has_struct_type(field)) {
+                struct_metadata = nested_index(field);
+            }
+            if (!field.map || (has_struct_type(field) && !struct_metadata) || in.peek() != '{') {
+                in.skip_value();
+                break;
+            }
+            // members are emplaced straight from the text, after reserving for the member count of the object
+            const map_ops& ops = *field.map;
+            ops.clear(field_ptr);
+            if (ops.reserve) {
+                ops.reserve(field_ptr, in.count_members());
+            }
+            field_metadata value_field = field;
+            value_field.type_code = field.sub_type_code;
+            value_field.offset = 0;
+            value_field.size = field.element_size;
+            in.expect('{');
+            if (!in.consume('}')) {
+                std::string scratch;
+                do {
+                    const std::string_view key = in.read_string(scratch);
+                    in.expect(':');
+                    decode_field(value_field, in, ops.emplace(field_ptr, key), mask);
+                } while (in.consume(','));
+                in.expect('}');
+            }
+            ops.finish(field_ptr);
+            break;
+        }
+        case TYPE_CODE::ENUM: {
+            const char c = in.peek();
+            long long raw = 0;
+            if (!field.enumeration) {
+                in.skip_value();
+            } else if (c == '"') {
+                std::string scratch;
+                const std::string_view name = in.read_string(scratch);
+                if (!field.enumeration->value_of(name, raw)) {
+                    report_field_error(field, "unknown enumerator: " + std::string(name));
                     break;
                 }
-                case TYPE_CODE::FLOAT: {
-                    const float& value =
-                        *reinterpret_cast<const float*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    result[field.name] = value;
+                field.enumeration->set(field_ptr, raw);
+            } else if (c == '-' || (c >= '0' && c <= '9')) {
+                if (!read_enum_value(*field.enumeration, in, raw)) {
+                    report_field_error(field, "number out of range");
                     break;
                 }
-                case TYPE_CODE::DOUBLE: {
-                    const double& value =
-                        *reinterpret_cast<const double*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    result[field.name] = value;
+                field.enumeration->set(field_ptr, raw);
+            } else {
+                in.skip_value();
+                report_field_error(field, "value is not an enumerator name or an integer");
+            }
+            break;
+        }
+        case TYPE_CODE::OPTIONAL: {
+            // the optional is only engaged by a value of the expected JSON type, which is decoded like a plain field
+            const char c = in.peek();
+            bool expected = false;
+            switch (field.sub_type_code) {
+                case TYPE_CODE::STRUCT:
+                    expected = c == '{' && has_struct_type(field);
+                    break;
+                case TYPE_CODE::STD_STRING:
+                    expected = c == '"';
+                    break;
+                case TYPE_CODE::BOOL:
+                    expected = c == 't' || c == 'f';
+                    break;
+                default:
+                    expected = c == '-' || (c >= '0' && c <= '9');
                     break;
+            }
+            if (!field.optional || !expected) {
+                in.skip_value();
+                report_field_error(field, "value does not match the optional type");
+                break;
+            }
+            field_metadata value_field = field;
+            value_field.type_code = field.sub_type_code;
+            value_field.offset = 0;
+            value_field.size = field.element_size;
+            decode_field(value_field, in, field.optional->emplace(field_ptr), mask);
+            break;
+        }
+        default:
+            // function pointers and unknown types are not deserialized
+            in.skip_value();
+            break;
+    }
+}
+
+// fields filled so far by one object decode, used to ignore duplicate keys when counting the selected ones
+// the bits live inline for up to 256 fields and on the heap for larger structs
+class field_bitset {
+private:
+    uint64_t inline_words[4] = {};
+    std::unique_ptr<uint64_t[]> heap_words;
+    uint64_t* words;
+
+public:
+    explicit field_bitset(size_t count) : words(inline_words) {
+        if (count > 64 * 4) {
+            heap_words.reset(new uint64_t[(count + 63) / 64]());
+            words = heap_words.get();
+        }
+    }
+
+    field_bitset(const field_bitset&) = delete;
+    field_bitset& operator=(const field_bitset&) = delete;
+
+    // mark a field, false when it was already marked
+    bool insert(size_t index) {
+        uint64_t& word = words[index / 64];
+        const uint64_t bit = uint64_t(1) << (index % 64);
+        if (word & bit) {
+            return false;
+        }
+        word |= bit;
+        return true;
+    }
+};
+
+// decode a JSON object into a struct, only the fields selected by the mask are materialized
+// with stop_early the scan ends as soon as every selected field has been filled; nested objects skip their remaining
+// members with the structural scanner instead
+inline void decode_struct(const key_index& metadata, json_scanner& in, void* obj, const field_mask* mask,
+                          bool stop_early) {
+    in.expect('{');
+    if (in.consume('}')) {
+        return;
+    }
+
+    size_t pending = mask ? mask->selected_count() : metadata.size();
+    field_bitset filled(mask ? metadata.size() : 0);
+    std::string scratch;
+    // the next key is expected to be the field that followed the previous one last time; only a miss reads the key
+    // and looks it up in the hash table of names, and then records the order that was actually seen
+    size_t previous = metadata.size();
+    do {
+        size_t index = metadata.next(previous);
+        if (index >= metadata.size() || !in.consume_key(metadata.key(index))) {
+            index = metadata.find(in.read_string(scratch));
+            if (index < metadata.size()) {
+                metadata.follow(previous, index);
+            }
+        }
+        in.expect(':');
+        if (index < metadata.size()) {
+            previous = index;
+        }
+
+        if (index == metadata.size() || (mask && !mask->selects(index))) {
+            in.skip_value();
+            continue;
+        }
+
+        decode_field(metadata[index], in, obj, mask ? mask->child(index) : nullptr);
+
+        if (mask && filled.insert(index)) {
+            if (--pending == 0) {
+                // every requested field is filled, do not look at the rest of the object
+                if (!stop_early) {
+                    in.skip_object_rest();
                 }
-                case TYPE_CODE::BOOL: {
-                    const bool& value =
-                        *reinterpret_cast<const bool*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    result[field.name] = value;
+                return;
+            }
+        }
+    } while (in.consume(','));
+    in.expect('}');
+}
+
+// forward declaration of the recursive struct validator
+inline void validate_struct(const std::vector<field_metadata>& metadata, json_scanner& in);
+
+// reject the value of a field, naming the field and the position of the problem
+[[noreturn]] inline void reject_field(const field_metadata& field, const json_scanner& in, const std::string& what) {
+    throw std::runtime_error("invalid value for field '" + std::string(field.name) + "' at offset " +
+                             std::to_string(in.offset()) + ": " + what);
+}
+
+// check that the number at the scanner fits a basic type slot, returns null when it does and the problem otherwise
+inline const char* check_number(TYPE_CODE type_code, json_scanner& in) {
+    const char c = in.peek();
+    if (c != '-' && (c < '0' || c > '9')) {
+        return "value is not a number";
+    }
+    if (is_integer_code(type_code)) {
+        uint64_t slot = 0;  // the value is stored, but not needed
+        switch (in.read_integer(type_code, &slot)) {
+            case integer_status::STORED:
+                return nullptr;
+            case integer_status::OUT_OF_RANGE:
+                return "number out of range";
+            default:
+                // a fraction or an exponent is decoded when the value is integral and fits
+                return store_number_token(type_code, &slot, in.read_number()) ? nullptr : "number out of range";
+        }
+    }
+    const number_token number = in.read_number();
+    if (type_code == TYPE_CODE::FLOAT) {
+        // the decoder narrows numbers beyond the float range to infinity, JSON text itself has no infinity
+        float value = 0;
+        return parse_floating(number.text, value) && !std::isinf(value) ? nullptr : "number out of range";
+    }
+    double value = 0;
+    return parse_floating(number.text, value) ? nullptr : "number out of range";
+}
+
+// check the text of a byte array: well-formed hex or base64 that decodes to at most capacity bytes
+inline const char* check_bytes(BYTES_FORMAT format, std::string_view text, size_t capacity) {
+    size_t stored = 0;
+    size_t count = 0;
+    if (format == BYTES_FORMAT::HEX) {
+        if (!decode_hex(text, nullptr, 0, stored)) {
+            return "invalid hex string";
+        }
+        count = text.size() / 2;
+    } else {
+        if (!decode_base64(text, nullptr, 0, stored)) {
+            return "invalid base64 string";
+        }
+        size_t length = text.size();
+        while (length > 0 && text[length - 1] == '=') {
+            --length;
+        }
+        count = length / 4 * 3 + (length % 4 > 0 ? length % 4 - 1 : 0);
+    }
+    return count <= capacity ? nullptr : "more bytes than the array holds";
+}
+
+inline void validate_field(const field_metadata& field, json_scanner& in);
+
+// check a JSON array against the extents of a fixed array (SIZE_MAX for a container), element by element
+inline void validate_elements(const field_metadata& element, const size_t* extents, size_t rank, json_scanner& in) {
+    if (in.peek() != '[') {
+        reject_field(element, in, "value is not an array");
+    }
+    in.expect('[');
+    if (in.consume(']')) {
+        return;
+    }
+    size_t i = 0;
+    do {
+        if (i == extents[0]) {
+            reject_field(element, in, "more than " + std::to_string(extents[0]) + " elements");
+        }
+        if (rank == 1) {
+            validate_field(element, in);
+        } else if (!in.consume_null()) {
+            validate_elements(element, extents + 1, rank - 1, in);
+        }
+        ++i;
+    } while (in.consume(','));
+    in.expect(']');
+}
+
+// check the JSON value at the scanner against one field, throws when decoding it would report an error or lose data
+inline void validate_field(const field_metadata& field, json_scanner& in) {
+    // null leaves any field untouched
+    if (in.consume_null()) {
+        return;
+    }
+    size_t length = 0;
+    switch (field.type_code) {
+        case TYPE_CODE::CHAR:
+        case TYPE_CODE::S_CHAR:
+        case TYPE_CODE::U_CHAR:
+        case TYPE_CODE::SHORT:
+        case TYPE_CODE::INT:
+        case TYPE_CODE::LONG:
+        case TYPE_CODE::LONG_LONG:
+        case TYPE_CODE::U_SHORT:
+        case TYPE_CODE::U_INT:
+        case TYPE_CODE::U_LONG:
+        case TYPE_CODE::U_LONG_LONG:
+        case TYPE_CODE::FLOAT:
+        case TYPE_CODE::DOUBLE:
+            if (const char* problem = check_number(field.type_code, in)) {
+                reject_field(field, in, problem);
+            }
+            break;
+        case TYPE_CODE::BOOL:
+            if (in.peek() != 't' && in.peek() != 'f') {
+                reject_field(field, in, "value is not a boolean");
+            }
+            in.read_bool();
+            break;
+        case TYPE_CODE::STRING:
+        case TYPE_CODE::STD_STRING:
+        case TYPE_CODE::STRING_VIEW: {
+            if (in.peek() != '"') {
+                reject_field(field, in, "value is not a string");
+            }
+            const std::string_view text = in.scan_string(length);
+            // char arrays keep a terminating NUL, views cannot represent escape sequences
+            if (field.type_code == TYPE_CODE::STRING && field.size > 0 && length >= field.size) {
+                reject_field(field, in, "string longer than " + std::to_string(field.size - 1) + " bytes");
+            }
+            if (field.type_code == TYPE_CODE::STRING_VIEW && text.size() != length) {
+                reject_field(field, in, "escaped string cannot be decoded into std::string_view");
+            }
+            break;
+        }
+        case TYPE_CODE::STRUCT: {
+            const std::vector<field_metadata>* struct_metadata = nullptr;
+            if (has_struct_type(field)) {
+                struct_metadata = nested_metadata(field);
+            }
+            if (!struct_metadata) {
+                in.check_value();
+                break;
+            }
+            if (in.peek() != '{') {
+                reject_field(field, in, "value is not an object");
+            }
+            validate_struct(*struct_metadata, in);
+            break;
+        }
+        case TYPE_CODE::ARRAY:
+        case TYPE_CODE::VECTOR: {
+            if (field.type_code == TYPE_CODE::ARRAY && field.bytes_format != BYTES_FORMAT::ARRAY && in.peek() == '"') {
+                // jston writes byte text without escapes, escaped text is not taken apart here
+                const std::string_view text = in.scan_string(length);
+                const char* problem = text.size() != length ? "escaped byte string"
+                                                            : check_bytes(field.bytes_format, text, field.size);
+                if (problem) {
+                    reject_field(field, in, problem);
+                }
+                break;
+            }
+            if (field.type_code == TYPE_CODE::VECTOR && !field.sequence) {
+                in.check_value();
+                break;
+            }
+            field_metadata element = field;
+            element.type_code = has_struct_type(field) ? TYPE_CODE::STRUCT : field.sub_type_code;
+            element.size = field.element_size;
+            element.bytes_format = BYTES_FORMAT::ARRAY;
+            const size_t capacity = field.type_code == TYPE_CODE::VECTOR ? std::numeric_limits<size_t>::max()
+                                    : field.element_size > 0         ? field.size / field.element_size
+                                                                     : 0;
+            if (field.type_code == TYPE_CODE::ARRAY && field.rank > 1 && field.extents) {
+                validate_elements(element, field.extents, field.rank, in);
+            } else {
+                validate_elements(element, &capacity, 1, in);
+            }
+            break;
+        }
+        case TYPE_CODE::MAP: {
+            if (!field.map) {
+                in.check_value();
+                break;
+            }
+            if (in.peek() != '{') {
+                reject_field(field, in, "value is not an object");
+            }
+            field_metadata value_field = field;
+            value_field.type_code = field.sub_type_code;
+            value_field.size = field.element_size;
+            in.expect('{');
+            if (!in.consume('}')) {
+                do {
+                    in.scan_string(length);
+                    in.expect(':');
+                    validate_field(value_field, in);
+                } while (in.consume(','));
+                in.expect('}');
+            }
+            break;
+        }
+        case TYPE_CODE::ENUM: {
+            const char c = in.peek();
+            long long raw = 0;
+            if (!field.enumeration) {
+                in.check_value();
+            } else if (c == '"') {
+                const std::string_view name = in.scan_string(length);
+                if (!field.enumeration->value_of(name, raw)) {
+                    reject_field(field, in, "unknown enumerator: " + std::string(name));
+                }
+            } else if (c != '-' && (c < '0' || c > '9')) {
+                reject_field(field, in, "value is not an enumerator name or an integer");
+            } else if (!read_enum_value(*field.enumeration, in, raw)) {
+                reject_field(field, in, "number out of range");
+            }
+            break;
+        }
+        case TYPE_CODE::OPTIONAL: {
+            // the same JSON types engage the optional as in decode_field
+            const char c = in.peek();
+            bool expected = false;
+            switch (field.sub_type_code) {
+                case TYPE_CODE::STRUCT:
+                    expected = c == '{' && has_struct_type(field);
+                    break;
+                case TYPE_CODE::STD_STRING:
+                    expected = c == '"';
+                    break;
+                case TYPE_CODE::BOOL:
+                    expected = c == 't' || c == 'f';
+                    break;
+                default:
+                    expected = c == '-' || (c >= '0' && c <= '9');
+                    break;
+            }
+            if (!field.optional || !expected) {
+                reject_field(field, in, "value does not match the optional type");
+            }
+            field_metadata value_field = field;
+            value_field.type_code = field.sub_type_code;
+            value_field.size = field.element_size;
+            validate_field(value_field, in);
+            break;
+        }
+        default:
+            // pointers, function pointers and unknown types are not decoded, any well-formed value is accepted
+            in.check_value();
+            break;
+    }
+}
+
+// check a JSON object against the fields of a struct, unknown members only need to be well-formed
+// keys are compared as written, so a key spelled with escape sequences counts as unknown
+inline void validate_struct(const std::vector<field_metadata>& metadata, json_scanner& in) {
+    in.expect('{');
+    if (in.consume('}')) {
+        return;
+    }
+    size_t next = 0;  // keys usually come in registration order, so the search starts after the previous field
+    do {
+        size_t length = 0;
+        const std::string_view key = in.scan_string(length);
+        in.expect(':');
+        size_t index = metadata.size();
+        for (size_t tried = 0, i = next; tried < metadata.size(); ++tried, i = i + 1 < metadata.size() ? i + 1 : 0) {
+            if (key == metadata[i].name) {
+                index = i;
+                break;
+            }
+        }
+        if (index == metadata.size()) {
+            in.check_value();
+            continue;
+        }
+        validate_field(metadata[index], in);
+        next = index + 1 < metadata.size() ? index + 1 : 0;
+    } while (in.consume(','));
+    in.expect('}');
+}
+
+// name of the first std::string_view field of a struct or of the structs nested in it, null if there is none
+inline const char* find_string_view_field(const std::vector<field_metadata>& metadata, size_t depth = 0) {
+    for (const field_metadata& field : metadata) {
+        if (field.type_code == TYPE_CODE::STRING_VIEW) {
+            return field.name;
+        }
+        // the depth bound stops at structs that contain themselves through a vector
+        const std::vector<field_metadata>* nested =
+            depth < 64 && has_struct_type(field) ? nested_metadata(field) : nullptr;
+        if (const char* name = nested ? find_string_view_field(*nested, depth + 1) : nullptr) {
+            return name;
+        }
+    }
+    return nullptr;
+}
+
+// incremental decoder behind jston::decoder: the text arrives in chunks of any size. an object of a registered struct
+// that is complete in the chunk it starts in is decoded by decode_struct; otherwise it is entered as its bracket
+// arrives, and so are arrays of structs and of basic types. every other value is collected until it is complete and
+// then decoded with decode_field. values that end in the chunk they start in are decoded in place, only values that
+// span chunks are copied, so the buffer holds a single value at a time
+class push_decoder {
+private:
+    // what the innermost object or array expects next
+    enum class expect : uint8_t {
+        KEY_OR_END,
+        KEY,
+        COLON,
+        VALUE,
+        COMMA_OR_END,
+        ELEMENT_OR_END,
+        ELEMENT,
+        COMMA_OR_CLOSE
+    };
+    // what a collected value is for
+    enum class collect : uint8_t { NONE, KEY, VALUE, ELEMENT, SKIP };
+
+    // an open object of a struct, or an open array field
+    struct frame {
+        bool array;
+        expect state;
+        const key_index* metadata;    // struct of the object or of the array elements, null for basic elements
+        char* obj;                    // the struct, or the struct holding the array field
+        const field_metadata* field;  // member being read, or the array field
+        size_t index;                 // last known member of an object, elements seen of an array
+        char* element;                // array element being collected
+    };
+
+    const key_index* metadata;
+    char* target;
+    std::vector<frame> stack;
+    bool started = false;
+    bool finished = false;
+    size_t position = 0;  // offset of the current chunk in the whole input
+    size_t used = 0;      // bytes of the last chunk that belong to the message
+
+    // value being collected: where it starts in the current chunk, the part from earlier chunks and its progress
+    collect collecting = collect::NONE;
+    const char* collect_from = nullptr;
+    size_t collect_offset = 0;
+    std::string pending;
+    std::string scratch;
+    size_t depth = 0;
+    bool in_string = false;
+    bool escaped = false;
+    bool scalar = false;
+
+    [[noreturn]] void fail(const char* data, const char* p, const std::string& what) const {
+        throw std::runtime_error("syntax error at offset " + std::to_string(position + (p - data)) + ": " + what);
+    }
+
+    // start collecting the value at p, whose first character is c
+    void begin_collect(collect role, const char* data, const char*& p, char c) {
+        collecting = role;
+        collect_from = p;
+        collect_offset = position + (p - data);
+        pending.clear();
+        depth = c == '{' || c == '[';
+        in_string = c == '"';
+        escaped = false;
+        scalar = !depth && !in_string;
+        p += !scalar;
+    }
+
+    // advance over the value being collected, true once it is complete with p just behind it
+    bool scan_collected(const char*& p, const char* end) {
+        while (p < end) {
+            const char c = *p;
+            if (in_string) {
+                if (escaped) {
+                    escaped = false;
+                    ++p;
+                    continue;
+                }
+                // jump to the next quote or backslash
+                const char* stop = p;
+                while (stop < end && *stop != '"' && *stop != '\\') {
+                    ++stop;
+                }
+                if (stop == end) {
+                    p = end;
+                    return false;
+                }
+                p = stop + 1;
+                if (*stop == '\\') {
+                    escaped = true;
+                } else {
+                    in_string = false;
+                    if (depth == 0) {
+                        return true;
+                    }
+                }
+                continue;
+            }
+            if (scalar) {
+                if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+                    return true;
+                }
+                ++p;
+                continue;
+            }
+            ++p;
+            if (c == '"') {
+                in_string = true;
+            } else if (c == '{' || c == '[') {
+                ++depth;
+            } else if ((c == '}' || c == ']') && --depth == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // look up the member key of the innermost object, speculating on the key order like decode_struct
+    static void find_member(frame& top, std::string_view key) {
+        const key_index& order = *top.metadata;
+        const size_t count = order.size();
+        size_t index = order.next(top.index);
+        const std::string* quoted = index < count ? &order.key(index).quoted : nullptr;
+        if (!quoted || quoted->size() != key.size() + 2 || memcmp(quoted->data() + 1, key.data(), key.size()) != 0) {
+            index = order.find(key);
+            if (index < count) {
+                order.follow(top.index, index);
+            }
+        }
+        top.field = index < count ? &(*top.metadata)[index] : nullptr;
+        if (index < count) {
+            top.index = index;
+        }
+        top.state = expect::COLON;
+    }
+
+    // a collected key or value is complete
+    void finish_collect(std::string_view text) {
+        frame& top = stack.back();
+        json_scanner in(text.data(), text.data() + text.size(), collect_offset);
+        in.set_strict(true);
+        switch (collecting) {
+            case collect::KEY:
+                find_member(top, in.read_string(scratch));
+                break;
+            case collect::VALUE:
+                decode_field(*top.field, in, top.obj, nullptr);
+                break;
+            case collect::ELEMENT:
+                decode_array_element(top.field->sub_type_code, in, top.element);
+                break;
+            case collect::SKIP:
+                in.skip_value();
+                break;
+            default:
+                break;
+        }
+        // a collected scalar ends at a delimiter, so anything the decoder did not take is malformed
+        if (!in.at_end()) {
+            in.fail("unexpected character");
+        }
+        collecting = collect::NONE;
+    }
+
+    // enter the object of a struct at p; one that is complete in this chunk is decoded by decode_struct in one go
+    void begin_struct(const key_index& fields, char* obj, const char* data, const char*& p,
+                      const char* end) {
+        json_scanner probe(p + 1, end);
+        if (probe.try_skip_nested(1) == nullptr) {
+            const size_t offset = position + static_cast<size_t>(p - data);
+            json_scanner in(p, end, offset);
+            in.set_strict(true);
+            decode_struct(fields, in, obj, nullptr, false);
+            p += in.offset() - offset;
+            finished = stack.empty();
+            return;
+        }
+        ++p;
+        stack.push_back(frame{false, expect::KEY_OR_END, &fields, obj, nullptr, fields.size(), nullptr});
+    }
+
+    // the value of a member starts with c: objects of structs and arrays are entered, the rest is collected
+    void begin_value(const char* data, const char*& p, const char* end, char c) {
+        frame& top = stack.back();
+        top.state = expect::COMMA_OR_END;
+        const field_metadata* field = top.field;
+        if (!field) {
+            begin_collect(collect::SKIP, data, p, c);
+            return;
+        }
+        // the arrays decode_field decodes element by element, std::vector<bool> has no addressable elements
+        const bool array = c == '[' && ((field->type_code == TYPE_CODE::VECTOR && field->sequence &&
+                                         (has_struct_type(*field) || field->sub_type_code != TYPE_CODE::BOOL)) ||
+                                        (field->type_code == TYPE_CODE::ARRAY && field->rank == 1 &&
+                                         field->bytes_format == BYTES_FORMAT::ARRAY));
+        const key_index* struct_metadata = nullptr;
+        if ((array || (c == '{' && field->type_code == TYPE_CODE::STRUCT)) && has_struct_type(*field)) {
+            struct_metadata = nested_index(*field);
+        }
+        if (struct_metadata && !array) {
+            JSTON_STATS_COUNT(fields_decoded);
+            begin_struct(*struct_metadata, top.obj + field->offset, data, p, end);
+        } else if (array && (struct_metadata ||
+                             (!has_struct_type(*field) && field->sub_type_code != TYPE_CODE::UNKNOWN))) {
+            JSTON_STATS_COUNT(fields_decoded);
+            char* obj = top.obj;
+            ++p;
+            stack.push_back(frame{true, expect::ELEMENT_OR_END, struct_metadata, obj, field, 0, nullptr});
+        } else {
+            begin_collect(collect::VALUE, data, p, c);
+        }
+    }
+
+    // an element of an array field starts with c, it is decoded in place like decode_field does
+    void begin_element(const char* data, const char*& p, const char* end, char c) {
+        frame& top = stack.back();
+        top.state = expect::COMMA_OR_CLOSE;
+        const field_metadata& field = *top.field;
+        char* field_ptr = top.obj + field.offset;
+        const size_t index = top.index++;
+        top.element = nullptr;
+        if (field.type_code == TYPE_CODE::VECTOR) {
+            if (index == field.sequence->size(field_ptr)) {
+                field.sequence->resize(field_ptr, index + 1);
+            }
+            top.element = static_cast<char*>(field.sequence->mutable_data(field_ptr)) + index * field.element_size;
+        } else if (field.element_size > 0 && index < field.size / field.element_size) {
+            top.element = field_ptr + index * field.element_size;
+        }
+        if (top.element && top.metadata && c == '{') {
+            begin_struct(*top.metadata, top.element, data, p, end);
+        } else if (top.element && !top.metadata) {
+            // a number or literal whose delimiter is in this chunk is decoded without collecting it
+            const char* stop = p;
+            while (stop < end && *stop != ',' && *stop != ']' && *stop != '}' && *stop != ' ' && *stop != '\n' &&
+                   *stop != '\r' && *stop != '\t' && *stop != '"' && *stop != '[' && *stop != '{') {
+                ++stop;
+            }
+            if (stop == end || stop == p) {
+                begin_collect(collect::ELEMENT, data, p, c);
+                return;
+            }
+            json_scanner in(p, stop, position + static_cast<size_t>(p - data));
+            in.set_strict(true);
+            decode_array_element(field.sub_type_code, in, top.element);
+            if (!in.at_end()) {
+                in.fail("expected ']'");
+            }
+            p = stop;
+        } else {
+            begin_collect(collect::SKIP, data, p, c);
+        }
+    }
+
+    // the closing bracket of the innermost object or array was read
+    void close_frame() {
+        const frame& top = stack.back();
+        if (top.array) {
+            char* field_ptr = top.obj + top.field->offset;
+            if (top.field->type_code == TYPE_CODE::VECTOR) {
+                top.field->sequence->resize(field_ptr, top.index);
+            } else {
+                set_live_length(*top.field, top.obj, top.index);
+            }
+        }
+        stack.pop_back();
+        finished = stack.empty();
+    }
+
+public:
+    push_decoder(const key_index& metadata, void* target)
+        : metadata(&metadata), target(static_cast<char*>(target)) {}
+
+    // start over with a new message decoded into target, the buffers are kept
+    void reset(void* obj) {
+        target = static_cast<char*>(obj);
+        stack.clear();
+        started = false;
+        finished = false;
+        position = 0;
+        used = 0;
+        collecting = collect::NONE;
+        pending.clear();
+    }
+
+    bool done() const {
+        return finished;
+    }
+
+    size_t consumed() const {
+        return used;
+    }
+
+    // take the next chunk of the message, stops behind the closing brace; true once the message is complete
+    bool feed(const char* data, size_t size) {
+        const char* p = data;
+        const char* end = data + size;
+        if (collecting != collect::NONE) {
+            collect_from = data;
+        }
+        while (p < end && !finished) {
+            if (collecting != collect::NONE) {
+                if (!scan_collected(p, end)) {
                     break;
                 }
-                case TYPE_CODE::STRING: {
-                    // char array
-                    const char* value =
-                        reinterpret_cast<const char*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    // create a safe std::string, handle only ascii characters
-                    std::string safe_string;
-                    size_t max_chars = field.size > 0 ? field.size : 256;  // use field size or default value
-                    for (size_t i = 0; i < max_chars; ++i) {
-                        unsigned char c = static_cast<unsigned char>(value[i]);
-                        if (c == '\0') {
-                            break;  // end of string
-                        }
-                        if (c < 128) {
-                            safe_string += c;  // add only ASCII characters
+                if (pending.empty()) {
+                    finish_collect(std::string_view(collect_from, static_cast<size_t>(p - collect_from)));
+                } else {
+                    pending.append(collect_from, p);
+                    finish_collect(pending);
+                }
+                continue;
+            }
+            const char c = *p;
+            if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+                ++p;
+                continue;
+            }
+            if (!started) {
+                if (c != '{') {
+                    fail(data, p, "JSON value is not an object, cannot convert to struct");
+                }
+                started = true;
+                begin_struct(*metadata, target, data, p, end);
+                continue;
+            }
+            frame& top = stack.back();
+            switch (top.state) {
+                case expect::KEY_OR_END:
+                case expect::KEY:
+                    if (c == '}' && top.state == expect::KEY_OR_END) {
+                        ++p;
+                        close_frame();
+                    } else if (c == '"') {
+                        // a key without escapes that ends in this chunk is looked up in place
+                        const char* quote = static_cast<const char*>(memchr(p + 1, '"', end - p - 1));
+                        if (quote && !memchr(p + 1, '\\', quote - p - 1)) {
+                            find_member(top, std::string_view(p + 1, static_cast<size_t>(quote - p - 1)));
+                            p = quote + 1;
+                        } else {
+                            begin_collect(collect::KEY, data, p, c);
                         }
+                    } else {
+                        fail(data, p, "expected string");
+                    }
+                    break;
+                case expect::COLON:
+                    if (c != ':') {
+                        fail(data, p, "expected ':'");
+                    }
+                    ++p;
+                    top.state = expect::VALUE;
+                    break;
+                case expect::VALUE:
+                    begin_value(data, p, end, c);
+                    break;
+                case expect::COMMA_OR_END:
+                    if (c == ',') {
+                        ++p;
+                        top.state = expect::KEY;
+                    } else if (c == '}') {
+                        ++p;
+                        close_frame();
+                    } else {
+                        fail(data, p, "expected '}'");
+                    }
+                    break;
+                case expect::ELEMENT_OR_END:
+                case expect::ELEMENT:
+                    if (c == ']' && top.state == expect::ELEMENT_OR_END) {
+                        ++p;
+                        close_frame();
+                    } else {
+                        begin_element(data, p, end, c);
+                    }
+                    break;
+                case expect::COMMA_OR_CLOSE:
+                    if (c == ',') {
+                        ++p;
+                        top.state = expect::ELEMENT;
+                    } else if (c == ']') {
+                        ++p;
+                        close_frame();
+                    } else {
+                        fail(data, p, "expected ']'");
                     }
-                    result[field.name] = safe_string;
                     break;
+            }
+        }
+        // a value still being collected continues in the next chunk
+        if (collecting != collect::NONE) {
+            pending.append(collect_from, end);
+        }
+        used = static_cast<size_t>(p - data);
+        position += used;
+        return finished;
+    }
+};
+
+// append one character of a JSON string literal, escaping like nlohmann::json::dump()
+template <typename Sink>
+inline void write_escaped_char(char c, Sink& out) {
+    switch (c) {
+        case '"':
+            return out.append("\\\"");
+        case '\\':
+            return out.append("\\\\");
+        case '\b':
+            return out.append("\\b");
+        case '\f':
+            return out.append("\\f");
+        case '\n':
+            return out.append("\\n");
+        case '\r':
+            return out.append("\\r");
+        case '\t':
+            return out.append("\\t");
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char* escape = out.extend(6);
+                memcpy(escape, "\\u00", 4);
+                escape[4] = hex_digits[c >> 4];
+                escape[5] = hex_digits[c & 0x0F];
+                return;
+            }
+            return out.put(c);
+    }
+}
+
+// append a JSON string literal, runs of characters that need no escape are copied at once
+template <typename Sink>
+inline void write_escaped(std::string_view text, Sink& out) {
+    out.put('"');
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(text.substr(start, i - start));
+        write_escaped_char(text[i], out);
+        start = i + 1;
+    }
+    out.append(text.substr(start));
+    out.put('"');
+}
+
+template <typename V, typename Sink>
+inline void write_integer(V value, Sink& out) {
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)));
+}
+
+// shortest text that reads back as the same value, with ".0" appended to integral values like nlohmann::json does;
+// non-finite values have no JSON representation and become null
+template <typename V, typename Sink>
+inline void write_floating(V value, Sink& out) {
+    if (!std::isfinite(value)) {
+        return out.append("null");
+    }
+    char buffer[40];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)));
+    if (std::find_if(buffer, result.ptr, [](char c) { return c == '.' || c == 'e'; }) == result.ptr) {
+        out.append(".0");
+    }
+}
+
+// append one value of a basic type or std::string, the text form of encode_basic_value
+template <typename Sink>
+inline void write_basic(TYPE_CODE type_code, const void* value, Sink& out) {
+    switch (type_code) {
+        case TYPE_CODE::CHAR:
+            return write_integer(static_cast<unsigned>(static_cast<uint8_t>(*static_cast<const char*>(value))), out);
+        case TYPE_CODE::S_CHAR:
+            return write_integer(static_cast<int>(*static_cast<const signed char*>(value)), out);
+        case TYPE_CODE::U_CHAR:
+            return write_integer(static_cast<unsigned>(*static_cast<const unsigned char*>(value)), out);
+        case TYPE_CODE::SHORT:
+            return write_integer(*static_cast<const short*>(value), out);
+        case TYPE_CODE::INT:
+            return write_integer(*static_cast<const int*>(value), out);
+        case TYPE_CODE::LONG:
+            return write_integer(*static_cast<const long*>(value), out);
+        case TYPE_CODE::LONG_LONG:
+            return write_integer(*static_cast<const long long*>(value), out);
+        case TYPE_CODE::U_SHORT:
+            return write_integer(*static_cast<const unsigned short*>(value), out);
+        case TYPE_CODE::U_INT:
+            return write_integer(*static_cast<const unsigned int*>(value), out);
+        case TYPE_CODE::U_LONG:
+            return write_integer(*static_cast<const unsigned long*>(value), out);
+        case TYPE_CODE::U_LONG_LONG:
+            return write_integer(*static_cast<const unsigned long long*>(value), out);
+        case TYPE_CODE::FLOAT:
+            return write_floating(*static_cast<const float*>(value), out);
+        case TYPE_CODE::DOUBLE:
+            return write_floating(*static_cast<const double*>(value), out);
+        case TYPE_CODE::BOOL:
+            return out.append(*static_cast<const bool*>(value) ? "true" : "false");
+        case TYPE_CODE::STD_STRING:
+            return write_escaped(*static_cast<const std::string*>(value), out);
+        default:
+            return out.append("\"[unknown_type]\"");
+    }
+}
+
+// append a JSON array of count contiguous elements, basic values or registered structs
+template <typename Sink>
+inline void write_elements(const field_metadata& field, const field_table* struct_metadata,
+                           const char* data, size_t count, const field_mask* mask, Sink& out) {
+    out.put('[');
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            out.put(',');
+        }
+        if (struct_metadata) {
+            write_struct(*struct_metadata, data + i * field.element_size, mask, out);
+        } else {
+            write_basic(field.sub_type_code, data + i * field.element_size, out);
+        }
+    }
+    out.put(']');
+}
+
+// append a multi-dimensional array as nested JSON arrays, the text form of encode_shaped
+template <typename Sink>
+inline void write_shaped(const field_metadata& field, const field_table* struct_metadata,
+                         const size_t* extents, size_t rank, const char* data, const field_mask* mask, Sink& out) {
+    if (rank == 1) {
+        return write_elements(field, struct_metadata, data, extents[0], mask, out);
+    }
+    const size_t stride = shaped_stride(extents, rank, field.element_size);
+    out.put('[');
+    for (size_t i = 0; i < extents[0]; ++i) {
+        if (i > 0) {
+            out.put(',');
+        }
+        write_shaped(field, struct_metadata, extents + 1, rank - 1, data + i * stride, mask, out);
+    }
+    out.put(']');
+}
+
+// the value of a field that the writer does not handle itself (arrays registered through the legacy macros without
+// element size or length), converted through the DOM walker; such fields have no size bound, so this never runs for
+// a buffer_sink
+template <typename Sink>
+inline void write_through_dom(const field_metadata& field, const void* obj, Sink& out) {
+    const std::vector<field_metadata> single{field};
+    out.append(to_json(single, obj, nullptr)[field.name].dump());
+}
+
+// append the value of one field, the text form of what to_json stores for it
+template <typename Sink>
+inline void write_field(const field_metadata& field, const void* obj, const field_mask* mask, Sink& out) {
+    const char* ptr = static_cast<const char*>(obj) + field.offset;
+    const field_table nested = has_struct_type(field) ? nested_table(field) : field_table();
+    const field_table* struct_metadata = nested.fields ? &nested : nullptr;
+    switch (field.type_code) {
+        case TYPE_CODE::STRING: {
+            // char array, bounded by its size and keeping only ascii characters like the DOM walker
+            const size_t max_chars = field.size > 0 ? field.size : 256;
+            out.put('"');
+            for (size_t i = 0; i < max_chars && ptr[i] != '\0'; ++i) {
+                if (static_cast<unsigned char>(ptr[i]) < 128) {
+                    write_escaped_char(ptr[i], out);
                 }
-                case TYPE_CODE::FUNCTION: {
-                    // simplified handling for function pointers
-                    result[field.name] = "[function_pointer]";
-                    break;
+            }
+            return out.put('"');
+        }
+        case TYPE_CODE::STRING_VIEW:
+            return write_escaped(*reinterpret_cast<const std::string_view*>(ptr), out);
+        case TYPE_CODE::FUNCTION:
+            return out.append("\"[function_pointer]\"");
+        case TYPE_CODE::POINTER:
+            return out.append("\"[pointer]\"");
+        case TYPE_CODE::STRUCT:
+            if (!struct_metadata) {
+                return out.append("\"[struct]\"");
+            }
+            return write_struct(*struct_metadata, ptr, mask, out);
+        case TYPE_CODE::ARRAY: {
+            if (field.element_size == 0 || field.array_length == 0 || (has_struct_type(field) && !struct_metadata)) {
+                return write_through_dom(field, obj, out);
+            }
+            if (field.bytes_format != BYTES_FORMAT::ARRAY) {
+                // the text is encoded in place, between the quotes
+                const size_t count = live_length(field, obj);
+                const unsigned char* bytes = reinterpret_cast<const unsigned char*>(ptr);
+                out.put('"');
+                if (field.bytes_format == BYTES_FORMAT::HEX) {
+                    encode_hex(bytes, count, out.extend(2 * count));
+                } else {
+                    encode_base64(bytes, count, out.extend(base64_length(count)));
                 }
-                case TYPE_CODE::POINTER: {
-                    // get the pointer value is not necessary
-                    result[field.name] = "[pointer]";
-                    break;
+                return out.put('"');
+            }
+            if (field.rank > 1 && field.extents) {
+                return write_shaped(field, struct_metadata, field.extents, field.rank, ptr, mask, out);
+            }
+            return write_elements(field, struct_metadata, ptr, live_length(field, obj), mask, out);
+        }
+        case TYPE_CODE::VECTOR: {
+            if (!field.sequence || (has_struct_type(field) && !struct_metadata)) {
+                return out.append(field.sequence ? "[]" : "\"[unknown_type]\"");
+            }
+            const size_t count = field.sequence->size(ptr);
+            const char* data = static_cast<const char*>(field.sequence->data(ptr));
+            if (!data && field.sub_type_code == TYPE_CODE::BOOL) {
+                // std::vector<bool> has no element storage
+                out.put('[');
+                for (size_t i = 0; i < count; ++i) {
+                    if (i > 0) {
+                        out.put(',');
+                    }
+                    out.append(field.sequence->get_bool(ptr, i) ? "true" : "false");
                 }
-                case TYPE_CODE::STRUCT: {
-                    // handle nested struct
-                    const void* struct_ptr =
-                        reinterpret_cast<const void*>(reinterpret_cast<const char*>(obj) + field.offset);
-
-                    // get struct type name and convert
-                    if (field.struct_type_name && *field.struct_type_name) {
-                        const auto* struct_metadata = MetadataManager::get_metadata(field.struct_type_name);
-                        if (struct_metadata) {
-                            result[field.name] = jston::to_json(*struct_metadata, struct_ptr);
-                        } else {
-                            result[field.name] = "[struct]";
-                        }
+                return out.put(']');
+            }
+            return write_elements(field, struct_metadata, data, count, mask, out);
+        }
+        case TYPE_CODE::MAP: {
+            if (!field.map) {
+                return out.append("\"[unknown_type]\"");
+            }
+            struct map_writer {
+                const field_metadata& field;
+                const field_table* struct_metadata;
+                const field_mask* mask;
+                Sink& out;
+                bool first;
+            } writer{field, struct_metadata, mask, out, true};
+            out.put('{');
+            field.map->for_each(
+                ptr,
+                [](void* context, std::string_view key, const void* value) {
+                    map_writer& w = *static_cast<map_writer*>(context);
+                    if (!w.first) {
+                        w.out.put(',');
+                    }
+                    w.first = false;
+                    write_escaped(key, w.out);
+                    w.out.put(':');
+                    if (w.struct_metadata) {
+                        write_struct(*w.struct_metadata, value, w.mask, w.out);
+                    } else if (has_struct_type(w.field)) {
+                        w.out.append("\"[struct]\"");
                     } else {
-                        result[field.name] = "[struct]";
+                        write_basic(w.field.sub_type_code, value, w.out);
                     }
-                    break;
-                }
-                case TYPE_CODE::ARRAY: {  // handle array
-                    const void* array_ptr =
-                        reinterpret_cast<const void*>(reinterpret_cast<const char*>(obj) + field.offset);
-                    nlohmann::json array = nlohmann::json::array();
+                },
+                &writer);
+            return out.put('}');
+        }
+        case TYPE_CODE::ENUM: {
+            if (!field.enumeration) {
+                return out.append("\"[unknown_type]\"");
+            }
+            const long long raw = field.enumeration->get(ptr);
+            const char* name = field.enumeration->as_name ? field.enumeration->name_of(raw) : nullptr;
+            if (name) {
+                return write_escaped(name, out);
+            }
+            return write_integer(raw, out);
+        }
+        case TYPE_CODE::OPTIONAL: {
+            if (!field.optional) {
+                return out.append("\"[unknown_type]\"");
+            }
+            const void* value = field.optional->value(ptr);
+            if (struct_metadata) {
+                return write_struct(*struct_metadata, value, mask, out);
+            }
+            if (has_struct_type(field)) {
+                return out.append("\"[struct]\"");
+            }
+            return write_basic(field.sub_type_code, value, out);
+        }
+        default:
+            return write_basic(field.type_code, ptr, out);
+    }
+}
 
-                    // prefer to use precomputed array element size and length
-                    if (field.element_size > 0 && field.array_length > 0) {
-                        // handle struct array
-                        if (field.struct_type_name && *field.struct_type_name) {
-                            // try to find corresponding struct metadata
-                            const auto* struct_metadata = MetadataManager::get_metadata(field.struct_type_name);
-                            if (struct_metadata) {
-                                // iterate through each element in array
-                                for (size_t i = 0; i < field.array_length; ++i) {
-                                    const void* element_ptr =
-                                        static_cast<const char*>(array_ptr) + i * field.element_size;
-                                    nlohmann::json element_json = jston::to_json(*struct_metadata, element_ptr);
-                                    array.push_back(element_json);
-                                }
-                            }
-                        } else {
-                            // handle basic type array
-                            // note: even if sub_type_code is UNKNOWN, we still try to handle to avoid random values
-                            // from uninitialized arrays for unrecognized types, we mark them as [unknown_array_type]
-                            if (field.sub_type_code == TYPE_CODE::UNKNOWN) {
-                                array.push_back("[unknown_array_type]");
-                            } else {
-                                switch (field.sub_type_code) {
-                                    case TYPE_CODE::DOUBLE: {
-                                        const double* double_array = static_cast<const double*>(array_ptr);
-                                        for (size_t i = 0; i < field.array_length; ++i) {
-                                            array.push_back(double_array[i]);
-                                        }
-                                        break;
-                                    }
-                                    case TYPE_CODE::FLOAT: {
-                                        const float* float_array = static_cast<const float*>(array_ptr);
-                                        for (size_t i = 0; i < field.array_length; ++i) {
-                                            array.push_back(float_array[i]);
-                                        }
-                                        break;
-                                    }
-                                    case TYPE_CODE::LONG_LONG: {
-                                        const long long* longlong_array = static_cast<const long long*>(array_ptr);
-                                        for (size_t i = 0; i < field.array_length; ++i) {
-                                            array.push_back(longlong_array[i]);
-                                        }
-                                        break;
-                                    }
-                                    case TYPE_CODE::LONG: {
-                                        const long* long_array = static_cast<const long*>(array_ptr);
-                                        for (size_t i = 0; i < field.array_length; ++i) {
-                                            array.push_back(long_array[i]);
-                                        }
-                                        break;
-                                    }
-                                    case TYPE_CODE::INT: {
-                                        const int* int_array = static_cast<const int*>(array_ptr);
-                                        for (size_t i = 0; i < field.array_length; ++i) {
-                                            array.push_back(int_array[i]);
-                                        }
-                                        break;
-                                    }
-                                    case TYPE_CODE::SHORT: {
-                                        const short* short_array = static_cast<const short*>(array_ptr);
-                                        for (size_t i = 0; i < field.array_length; ++i) {
-                                            array.push_back(short_array[i]);
-                                        }
-                                        break;
-                                    }
-                                    case TYPE_CODE::U_INT: {
-                                        const unsigned int* uint_array = static_cast<const unsigned int*>(array_ptr);
-                                        for (size_t i = 0; i < field.array_length; ++i) {
-                                            array.push_back(uint_array[i]);
-                                        }
-                                        break;
-                                    }
-                                    case TYPE_CODE::U_SHORT: {
-                                        const unsigned short* ushort_array =
-                                            static_cast<const unsigned short*>(array_ptr);
-                                        for (size_t i = 0; i < field.array_length; ++i) {
-                                            array.push_back(ushort_array[i]);
-                                        }
-                                        break;
-                                    }
-                                    case TYPE_CODE::BOOL: {
-                                        const bool* bool_array = static_cast<const bool*>(array_ptr);
-                                        for (size_t i = 0; i < field.array_length; ++i) {
-                                            array.push_back(bool_array[i]);
-                                        }
-                                        break;
-                                    }
-                                    default:
-                                        // unrecognized array type
-                                        array.push_back("[unknown_array]");
-                                        break;
-                                }
-                            }
-                        }
-                    } else {
-                        // use traditional method to handle arrays as fallback solution
-                        // handling priority: 1. prefer struct_type_name for precise matching
-                        // first check if struct_type_name exists and is valid
-                        if (field.struct_type_name && *field.struct_type_name) {
-                            // try to find corresponding struct metadata
-                            const auto* struct_metadata = MetadataManager::get_metadata(field.struct_type_name);
-                            if (struct_metadata) {
-                                // calculate array element size
-                                size_t element_size = 0;
-                                for (const auto& f : *struct_metadata) {
-                                    size_t field_end = f.offset + (f.size > 0 ? f.size : sizeof(void*));
-                                    if (field_end > element_size) {
-                                        element_size = field_end;
-                                    }
-                                }
+// append a struct as a JSON object, fields in registration order; absent optionals and fields not selected by the
+// mask are left out like in to_json
+template <typename Sink>
+inline void write_struct(field_table metadata, const void* obj, const field_mask* mask, Sink& out) {
+    out.put('{');
+    bool first = true;
+    for (size_t index = 0; index < metadata.size(); ++index) {
+        const field_metadata& field = metadata[index];
+        if (mask && !mask->selects(index)) {
+            continue;
+        }
+        if (field.type_code == TYPE_CODE::OPTIONAL && field.optional &&
+            !field.optional->has_value(static_cast<const char*>(obj) + field.offset)) {
+            continue;
+        }
+        JSTON_STATS_COUNT(fields_encoded);
+        if (!first) {
+            out.put(',');
+        }
+        first = false;
+        out.put('"');
+        out.append(field.name);
+        out.append("\":");
+        write_field(field, obj, mask ? mask->child(index) : nullptr, out);
+    }
+    out.put('}');
+}
+
+}  // namespace detail
+
+#if defined(JSTON_HAS_COROUTINES)
+
+// lazily produced sequence of JSON text chunks returned by encode_chunks, iterated once; each chunk is a view that
+// stays valid until the iterator is advanced, which resumes the encoder
+class chunk_generator {
+public:
+    struct promise_type {
+        std::string_view chunk;
+        std::exception_ptr error;
+
+        chunk_generator get_return_object() {
+            return chunk_generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+        std::suspend_always yield_value(std::string_view value) noexcept {
+            chunk = value;
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {
+            error = std::current_exception();
+        }
+    };
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+
+        iterator() = default;
+        explicit iterator(std::coroutine_handle<promise_type> coroutine) : coroutine(coroutine) {}
+
+        reference operator*() const {
+            return coroutine.promise().chunk;
+        }
+        iterator& operator++() {
+            resume(coroutine);
+            return *this;
+        }
+        void operator++(int) {
+            ++*this;
+        }
+        bool operator==(std::default_sentinel_t) const {
+            return !coroutine || coroutine.done();
+        }
+
+    private:
+        std::coroutine_handle<promise_type> coroutine;
+    };
+
+    chunk_generator(chunk_generator&& other) noexcept : coroutine(std::exchange(other.coroutine, nullptr)) {}
+    chunk_generator& operator=(chunk_generator&& other) noexcept {
+        if (this != &other) {
+            if (coroutine) {
+                coroutine.destroy();
+            }
+            coroutine = std::exchange(other.coroutine, nullptr);
+        }
+        return *this;
+    }
+    ~chunk_generator() {
+        if (coroutine) {
+            coroutine.destroy();
+        }
+    }
+
+    // runs the encoder up to the first chunk
+    iterator begin() {
+        resume(coroutine);
+        return iterator(coroutine);
+    }
+    std::default_sentinel_t end() const noexcept {
+        return {};
+    }
+
+private:
+    std::coroutine_handle<promise_type> coroutine;
+
+    explicit chunk_generator(std::coroutine_handle<promise_type> coroutine) : coroutine(coroutine) {}
+
+    // run the encoder to its next chunk, an exception thrown by it surfaces here
+    static void resume(std::coroutine_handle<promise_type> coroutine) {
+        if (coroutine && !coroutine.done()) {
+            coroutine.resume();
+            if (std::exception_ptr error = std::exchange(coroutine.promise().error, nullptr)) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+};
+
+namespace detail {
+
+// worst-case text length of a struct known only by its metadata, 0 when any field is unbounded; the run time
+// counterpart of max_struct_size
+inline size_t struct_text_bound(field_table metadata) {
+    size_t total = 2;
+    for (size_t index = 0; index < metadata.size(); ++index) {
+        if (metadata[index].max_json_size == 0) {
+            return 0;
+        }
+        total += (index > 0 ? 1 : 0) + strlen(metadata[index].name) + 3 + metadata[index].max_json_size;
+    }
+    return total;
+}
+
+inline chunk_generator write_struct_chunks(field_table metadata, const char* obj, std::string& buffer,
+                                           size_t chunk_size);
+
+// write the value of a field that may not fit a chunk: nested structs (optional ones too) and the elements of fixed
+// arrays, vectors and maps are written one by one, and the buffer is handed out whenever it reaches chunk_size.
+// other values (strings, std::vector<bool>, multi-dimensional and byte arrays) are written whole
+inline chunk_generator write_field_chunks(const field_metadata& field, const char* obj, std::string& buffer,
+                                          size_t chunk_size) {
+    string_sink out{buffer};
+    const char* ptr = obj + field.offset;
+    const field_table nested = has_struct_type(field) ? nested_table(field) : field_table();
+    const field_table* struct_metadata = nested.fields ? &nested : nullptr;
+    if ((field.type_code == TYPE_CODE::STRUCT || field.type_code == TYPE_CODE::OPTIONAL) && struct_metadata) {
+        const char* value = field.type_code == TYPE_CODE::OPTIONAL && field.optional
+                                ? static_cast<const char*>(field.optional->value(ptr))
+                                : ptr;
+        for (std::string_view chunk : write_struct_chunks(nested, value, buffer, chunk_size)) {
+            co_yield chunk;
+        }
+        co_return;
+    }
+    const bool elements = struct_metadata || (!has_struct_type(field) && field.sub_type_code != TYPE_CODE::UNKNOWN);
+    const bool is_map = field.type_code == TYPE_CODE::MAP && elements && field.map && field.map->next;
+    const char* data = nullptr;
+    size_t count = 0;
+    if (field.type_code == TYPE_CODE::ARRAY && elements && field.bytes_format == BYTES_FORMAT::ARRAY &&
+        field.rank == 1 && field.element_size > 0 && field.array_length > 0) {
+        data = ptr;
+        count = live_length(field, obj);
+    } else if (field.type_code == TYPE_CODE::VECTOR && elements && field.sequence) {
+        data = static_cast<const char*>(field.sequence->data(ptr));
+        count = field.sequence->size(ptr);
+    }
+    if (!data && !is_map) {
+        write_field(field, obj, nullptr, out);
+        co_return;
+    }
+    // struct elements that always fit a chunk are written whole, larger ones field by field
+    const size_t element_bound = struct_metadata ? struct_text_bound(nested) : 0;
+    map_cursor cursor;
+    if (is_map) {
+        field.map->first(ptr, cursor);
+    }
+    out.put(is_map ? '{' : '[');
+    for (size_t i = 0;; ++i) {
+        const char* element = nullptr;
+        if (is_map) {
+            std::string_view key;
+            const void* value = nullptr;
+            if (!field.map->next(ptr, cursor, key, value)) {
+                break;
+            }
+            if (i > 0) {
+                out.put(',');
+            }
+            write_escaped(key, out);
+            out.put(':');
+            element = static_cast<const char*>(value);
+        } else {
+            if (i == count) {
+                break;
+            }
+            if (i > 0) {
+                out.put(',');
+            }
+            element = data + i * field.element_size;
+        }
+        if (!struct_metadata) {
+            write_basic(field.sub_type_code, element, out);
+        } else if (element_bound > 0 && element_bound <= chunk_size) {
+            write_struct(nested, element, nullptr, out);
+        } else {
+            for (std::string_view chunk : write_struct_chunks(nested, element, buffer, chunk_size)) {
+                co_yield chunk;
+            }
+        }
+        if (buffer.size() >= chunk_size) {
+            co_yield std::string_view(buffer);
+            buffer.clear();
+        }
+    }
+    out.put(is_map ? '}' : ']');
+}
+
+// write_struct as a coroutine: fields whose text may not fit a chunk are written by write_field_chunks, and the
+// buffer is handed out after any field that fills it to chunk_size
+inline chunk_generator write_struct_chunks(field_table metadata, const char* obj, std::string& buffer,
+                                           size_t chunk_size) {
+    string_sink out{buffer};
+    out.put('{');
+    bool first = true;
+    for (const field_metadata& field : metadata) {
+        if (field.type_code == TYPE_CODE::OPTIONAL && field.optional &&
+            !field.optional->has_value(obj + field.offset)) {
+            continue;
+        }
+        JSTON_STATS_COUNT(fields_encoded);
+        if (!first) {
+            out.put(',');
+        }
+        first = false;
+        out.put('"');
+        out.append(field.name);
+        out.append("\":");
+        const bool bounded = field.max_json_size > 0 && field.max_json_size <= chunk_size;
+        if (!bounded && (field.type_code == TYPE_CODE::STRUCT || field.type_code == TYPE_CODE::ARRAY ||
+                         field.type_code == TYPE_CODE::VECTOR || field.type_code == TYPE_CODE::MAP ||
+                         field.type_code == TYPE_CODE::OPTIONAL)) {
+            for (std::string_view chunk : write_field_chunks(field, obj, buffer, chunk_size)) {
+                co_yield chunk;
+            }
+        } else {
+            write_field(field, obj, nullptr, out);
+        }
+        if (buffer.size() >= chunk_size) {
+            co_yield std::string_view(buffer);
+            buffer.clear();
+        }
+    }
+    out.put('}');
+}
+
+}  // namespace detail
+
+// struct to JSON text in chunks, produced as the metadata walk proceeds: the walk is suspended after each chunk until
+// the consumer asks for the next one, so a large struct can be written to a non-blocking socket without holding its
+// whole text. the chunks add up to the text of to_json_string; each but the last holds at least chunk_size bytes and
+// goes beyond it by at most one value written whole: a basic value, a string, a std::vector<bool>, a byte or
+// multi-dimensional array, or a map of a container whose iterator does not fit a map_cursor. obj must outlive the
+// generator and stay unchanged while it is consumed. needs C++20
+template <typename T>
+chunk_generator encode_chunks(const T& obj, size_t chunk_size) {
+    const field_table metadata = fields_of<T>();
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    std::string buffer;
+    buffer.reserve(2 * chunk_size);
+    for (std::string_view chunk :
+         detail::write_struct_chunks(metadata, reinterpret_cast<const char*>(&obj), buffer, chunk_size)) {
+        co_yield chunk;
+    }
+    if (!buffer.empty()) {
+        co_yield std::string_view(buffer);
+    }
+}
+
+#endif
+
+// partial JSON string to struct conversion function
+// only the fields selected by the mask are decoded, everything else is skipped by a structural scan without number or
+// string decoding, and scanning stops as soon as every selected field has been filled
+template <typename T>
+void from_json_string(std::string_view j, T& obj, const field_mask& mask) {
+    JSTON_STATS_SCOPE();
+    JSTON_METRICS_SCOPE(T, decode);
+    JSTON_METRICS_BYTES(j.size());
+    if (j.empty()) {
+        throw std::runtime_error("empty json string provided");
+    }
+
+    const detail::key_index& metadata = detail::key_index_of<T>();
+
+    detail::json_scanner in(j.data(), j.data() + j.size());
+    if (in.peek() != '{') {
+        throw std::runtime_error("JSON value is not an object, cannot convert to struct");
+    }
+    try {
+        detail::decode_struct(metadata, in, &obj, &mask, true);
+    } catch (const std::exception& e) {
+        throw std::runtime_error(std::string("json parsing error: ") + e.what());
+    }
+}
+
+// JSON string to struct conversion function
+// the text is decoded directly without building a DOM, so numbers are parsed straight into the field type. the whole
+// text is checked: members of unknown fields and values of the wrong JSON type are skipped, but their syntax is
+// validated like validate does (the masked overload above only matches their brackets and quotes)
+// std::string_view fields point into j, which must then outlive obj
+template <typename T>
+void from_json_string(std::string_view j, T& obj) {
+    JSTON_STATS_SCOPE();
+    JSTON_METRICS_SCOPE(T, decode);
+    JSTON_METRICS_BYTES(j.size());
+    if (j.empty()) {
+        throw std::runtime_error("empty json string provided");
+    }
+
+    const detail::key_index& metadata = detail::key_index_of<T>();
+
+    detail::json_scanner in(j.data(), j.data() + j.size());
+    in.set_strict(true);
+    if (in.peek() != '{') {
+        throw std::runtime_error("JSON value is not an object, cannot convert to struct");
+    }
+    try {
+        detail::decode_struct(metadata, in, &obj, nullptr, false);
+        if (!in.at_end()) {
+            in.fail("unexpected trailing characters");
+        }
+    } catch (const std::exception& e) {
+        throw std::runtime_error(std::string("json parsing error: ") + e.what());
+    }
+}
 
-                                // ensure alignment
-                                element_size = (element_size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+// a string literal or a C string owned by the caller
+template <typename T>
+void from_json_string(const char* j, T& obj) {
+    from_json_string(std::string_view(j), obj);
+}
 
-                                // calculate number of elements in array
-                                int array_size = field.size / element_size;
+template <typename T>
+void from_json_string(const char* j, T& obj, const field_mask& mask) {
+    from_json_string(std::string_view(j), obj, mask);
+}
 
-                                // iterate through each element in array
-                                for (int i = 0; i < array_size; ++i) {
-                                    const void* element_ptr = static_cast<const char*>(array_ptr) + i * element_size;
-                                    nlohmann::json element_json = jston::to_json(*struct_metadata, element_ptr);
-                                    array.push_back(element_json);
-                                }
-                            } else {
-                                // not a struct array, use sub_type_code to precisely match basic type array
-                                // this is the main matching method to ensure type safety and precise conversion
-                                if (field.sub_type_code == TYPE_CODE::DOUBLE) {
-                                    const double* double_array = static_cast<const double*>(array_ptr);
-                                    int array_size = field.size / sizeof(double);
-                                    for (int i = 0; i < array_size; ++i) {
-                                        array.push_back(double_array[i]);
-                                    }
-                                } else if (field.sub_type_code == TYPE_CODE::FLOAT) {
-                                    const float* float_array = static_cast<const float*>(array_ptr);
-                                    int array_size = field.size / sizeof(float);
-                                    for (int i = 0; i < array_size; ++i) {
-                                        array.push_back(float_array[i]);
-                                    }
-                                } else if (field.sub_type_code == TYPE_CODE::LONG_LONG) {
-                                    const long long* longlong_array = static_cast<const long long*>(array_ptr);
-                                    int array_size = field.size / sizeof(long long);
-                                    for (int i = 0; i < array_size; ++i) {
-                                        array.push_back(longlong_array[i]);
-                                    }
-                                } else if (field.sub_type_code == TYPE_CODE::LONG) {
-                                    const long* long_array = static_cast<const long*>(array_ptr);
-                                    int array_size = field.size / sizeof(long);
-                                    for (int i = 0; i < array_size; ++i) {
-                                        array.push_back(long_array[i]);
-                                    }
-                                } else if (field.sub_type_code == TYPE_CODE::INT) {
-                                    const int* int_array = static_cast<const int*>(array_ptr);
-                                    int array_size = field.size / sizeof(int);
-                                    for (int i = 0; i < array_size; ++i) {
-                                        array.push_back(int_array[i]);
-                                    }
-                                } else if (field.sub_type_code == TYPE_CODE::SHORT) {
-                                    const short* short_array = static_cast<const short*>(array_ptr);
-                                    int array_size = field.size / sizeof(short);
-                                    for (int i = 0; i < array_size; ++i) {
-                                        array.push_back(short_array[i]);
-                                    }
-                                } else if (field.sub_type_code == TYPE_CODE::U_INT) {
-                                    const unsigned int* uint_array = static_cast<const unsigned int*>(array_ptr);
-                                    int array_size = field.size / sizeof(unsigned int);
-                                    for (int i = 0; i < array_size; ++i) {
-                                        array.push_back(uint_array[i]);
-                                    }
-                                } else if (field.sub_type_code == TYPE_CODE::U_SHORT) {
-                                    const unsigned short* ushort_array = static_cast<const unsigned short*>(array_ptr);
-                                    int array_size = field.size / sizeof(unsigned short);
-                                    for (int i = 0; i < array_size; ++i) {
-                                        array.push_back(ushort_array[i]);
-                                    }
-                                } else if (field.sub_type_code == TYPE_CODE::BOOL) {
-                                    const bool* bool_array = static_cast<const bool*>(array_ptr);
-                                    int array_size = field.size / sizeof(bool);
-                                    for (int i = 0; i < array_size; ++i) {
-                                        array.push_back(bool_array[i]);
-                                    }
-                                } else {
-                                    // unrecognized array type
-                                    array.push_back("[unknown_array]");
-                                }
-                            }
-                        }
-                    }
-                    // only add this field if it doesn't exist in result yet
-                    if (!result.contains(field.name)) {
-                        result[field.name] = array;
-                    }
-                    break;
-                }
-                default:
-                    result[field.name] = "[unknown_type]";
-                    break;
+// a temporary string is gone when the call returns, so it cannot back std::string_view fields
+template <typename T>
+void from_json_string(std::string&& j, T& obj) {
+    static_assert(!has_string_view_fields<T>,
+                  "from_json_string: the std::string_view fields of the struct would point into a temporary string, "
+                  "pass a string that outlives the struct");
+    from_json_string(std::string_view(j), obj);
+}
+
+template <typename T>
+void from_json_string(std::string&& j, T& obj, const field_mask& mask) {
+    static_assert(!has_string_view_fields<T>,
+                  "from_json_string: the std::string_view fields of the struct would point into a temporary string, "
+                  "pass a string that outlives the struct");
+    from_json_string(std::string_view(j), obj, mask);
+}
+
+// check that j is a JSON object that from_json_string would decode into T without a field error or lost data,
+// without writing to any object or allocating (only a rejection builds its message). besides the syntax of the whole
+// text, members of known fields must have the JSON type of the field, numbers must fit the field type (integral
+// values for integer fields, finite values for float fields), strings must fit char arrays and arrays must not be
+// longer than fixed arrays; null is accepted for any field since decoding leaves it untouched. on failure the reason
+// is stored in error if given
+template <typename T>
+bool validate(std::string_view j, std::string* error = nullptr) {
+    JSTON_STATS_SCOPE();
+    const auto& metadata = require_metadata<T>();
+
+    detail::json_scanner in(j.data(), j.data() + j.size());
+    try {
+        if (in.peek() != '{') {
+            in.fail("JSON value is not an object");
+        }
+        detail::validate_struct(metadata, in);
+        if (!in.at_end()) {
+            in.fail("unexpected trailing characters");
+        }
+    } catch (const std::exception& e) {
+        if (error) {
+            *error = e.what();
+        }
+        return false;
+    }
+    return true;
+}
+
+// incremental decoder for JSON text that arrives in pieces, e.g. from a socket, without first accumulating the whole
+// message. every feed() continues where the previous one stopped, including inside a string or number, and fields are
+// written into the target as soon as their value is complete. feed() returns true once the closing brace of the
+// message was read; bytes behind it are not consumed (consumed() tells how many were), so the rest of the chunk can
+// be fed to the next message after reset(). decoding is the same as from_json_string; after an exception the decoder
+// has to be reset. structs with std::string_view fields are rejected at compile time: a view could only point into a
+// chunk or into the decoder's own buffer, and neither outlives the message
+template <typename T>
+class decoder {
+    static_assert(!has_string_view_fields<T>,
+                  "jston::decoder: std::string_view fields cannot be decoded incrementally, the chunks they would "
+                  "point into are gone by the time the message is complete");
+
+private:
+    detail::push_decoder state;
+
+public:
+    explicit decoder(T& target) : state(detail::key_index_of<T>(), &target) {
+        // types registered at runtime have no compile-time table to check
+        if constexpr (!struct_info<T>::is_registered) {
+            if (const char* name = detail::find_string_view_field(require_metadata<T>())) {
+                throw std::runtime_error(std::string("std::string_view field '") + name +
+                                         "' cannot be decoded incrementally");
             }
+        }
+    }
+
+    bool feed(const char* data, size_t size) {
+        JSTON_STATS_SCOPE();
+        try {
+            return state.feed(data, size);
         } catch (const std::exception& e) {
-            std::cerr << "Error converting field '" << field.name << "': " << e.what() << std::endl;
-            result[field.name] = "[error]";
+            throw std::runtime_error(std::string("json parsing error: ") + e.what());
         }
     }
 
-    return result;
-}
+    bool feed(std::string_view chunk) {
+        return feed(chunk.data(), chunk.size());
+    }
 
-// three-parameter from_json function implementation
-inline void from_json(const std::vector<field_metadata>& metadata, const nlohmann::json& j, void* obj) {
-    // iterate through all fields and convert
-    for (const auto& field : metadata) {
-        try {
-            // check if field exists and is not null
-            if (j.find(field.name) == j.end() || j[field.name].is_null()) {
-                continue;
-            }
+    // true once the whole message has been decoded
+    bool done() const {
+        return state.done();
+    }
 
-            // handle differently based on field type
-            switch (field.type_code) {
-                case TYPE_CODE::CHAR: {
-                    char& value = *reinterpret_cast<char*>(reinterpret_cast<char*>(obj) + field.offset);
-                    value = static_cast<char>(j[field.name].get<uint8_t>());
-                    break;
-                }
-                case TYPE_CODE::SHORT: {
-                    short& value = *reinterpret_cast<short*>(reinterpret_cast<char*>(obj) + field.offset);
-                    value = j[field.name].get<short>();
-                    break;
-                }
-                case TYPE_CODE::INT: {
-                    int& value = *reinterpret_cast<int*>(reinterpret_cast<char*>(obj) + field.offset);
-                    value = j[field.name].get<int>();
-                    break;
-                }
-                case TYPE_CODE::LONG: {
-                    long& value = *reinterpret_cast<long*>(reinterpret_cast<char*>(obj) + field.offset);
-                    value = j[field.name].get<long>();
-                    break;
-                }
-                case TYPE_CODE::LONG_LONG: {
-                    long long& value = *reinterpret_cast<long long*>(reinterpret_cast<char*>(obj) + field.offset);
-                    value = j[field.name].get<long long>();
-                    break;
-                }
-                case TYPE_CODE::U_SHORT: {
-                    unsigned short& value =
-                        *reinterpret_cast<unsigned short*>(reinterpret_cast<char*>(obj) + field.offset);
-                    value = j[field.name].get<unsigned short>();
-                    break;
-                }
-                case TYPE_CODE::U_INT: {
-                    unsigned int& value = *reinterpret_cast<unsigned int*>(reinterpret_cast<char*>(obj) + field.offset);
-                    value = j[field.name].get<unsigned int>();
-                    break;
-                }
-                case TYPE_CODE::U_LONG: {
-                    unsigned long& value =
-                        *reinterpret_cast<unsigned long*>(reinterpret_cast<char*>(obj) + field.offset);
-                    value = j[field.name].get<unsigned long>();
-                    break;
-                }
-                case TYPE_CODE::U_LONG_LONG: {
-                    unsigned long long& value =
-                        *reinterpret_cast<unsigned long long*>(reinterpret_cast<char*>(obj) + field.offset);
-                    value = j[field.name].get<unsigned long long>();
-                    break;
-                }
-                case TYPE_CODE::FLOAT: {
-                    float& value = *reinterpret_cast<float*>(reinterpret_cast<char*>(obj) + field.offset);
-                    value = j[field.name].get<float>();
-                    break;
-                }
-                case TYPE_CODE::DOUBLE: {
-                    double& value = *reinterpret_cast<double*>(reinterpret_cast<char*>(obj) + field.offset);
-                    value = j[field.name].get<double>();
-                    break;
-                }
-                case TYPE_CODE::BOOL: {
-                    bool& value = *reinterpret_cast<bool*>(reinterpret_cast<char*>(obj) + field.offset);
-                    value = j[field.name].get<bool>();
-                    break;
-                }
-                case TYPE_CODE::STRING: {
-                    // check if this is a char pointer (char* or const char*)
-                    if (std::is_pointer<decltype(*reinterpret_cast<void**>(reinterpret_cast<char*>(obj) + field.offset))>::value) {
-                        // for char pointers, we don't perform deserialization as we can't know where to allocate memory
-                        // just leave the pointer as it is (null or existing)
-                        break;
-                    }
-                    // regular char array (c-style string) handling
-                    char* value = reinterpret_cast<char*>(reinterpret_cast<char*>(obj) + field.offset);
-                    try {
-                        std::string str_value = j[field.name].get<std::string>();
-                        // use strncpy to prevent overflow and manually add string terminator
-                        if (field.size > 0) {
-                            strncpy(value, str_value.c_str(), field.size - 1);
-                            value[field.size - 1] = '\0';  // ensure string termination
-                        }
-                    } catch (const std::exception& e) {
-                        // handle potential string conversion errors
-                        throw std::runtime_error(
-                            std::string("Error converting field '" + std::string(field.name) + "': ") + e.what());
-                    }
-                    break;
-                }
-                case TYPE_CODE::FUNCTION: {
-                    // do not deserialize function pointers
-                    break;
+    // bytes of the last chunk that belong to the message
+    size_t consumed() const {
+        return state.consumed();
+    }
+
+    // decode the next message into target, internal buffers are reused
+    void reset(T& target) {
+        state.reset(&target);
+    }
+};
+
+// kind of the JSON value at a cursor position
+enum class JSON_TYPE : uint8_t { OBJECT, ARRAY, STRING, NUMBER, BOOLEAN, NULL_VALUE, END };
+
+// forward-only reader over JSON text for mixing custom logic with struct decoding, e.g. reading a version field and
+// then decoding a sub-object into the struct it selects, without building a DOM. every value reached must be
+// consumed once: read, skipped, taken as a raw slice, decoded into a struct or iterated to its end. a copy of a cursor
+// is a bookmark, reading from it leaves the original where it was. the text must outlive the cursor and every view
+// it returns; views of strings with escape sequences are only valid until the next read
+class json_cursor {
+private:
+    std::string_view text;
+    detail::json_scanner in;
+    bool after_open = false;  // directly after '{' or '[', where no comma may come before the first item
+    std::string scratch;
+
+    // step to the next item of the current container, false when its closing bracket was consumed instead
+    bool next_item(char close) {
+        const bool first = after_open;
+        after_open = false;
+        if (in.consume(close)) {
+            return false;
+        }
+        if (!first) {
+            in.expect(',');
+        }
+        return true;
+    }
+
+public:
+    explicit json_cursor(std::string_view text) : text(text), in(text.data(), text.data() + text.size()) {}
+
+    // kind of the next value, END when only whitespace is left
+    JSON_TYPE type() {
+        const char c = in.peek();
+        switch (c) {
+            case '{':
+                return JSON_TYPE::OBJECT;
+            case '[':
+                return JSON_TYPE::ARRAY;
+            case '"':
+                return JSON_TYPE::STRING;
+            case 't':
+            case 'f':
+                return JSON_TYPE::BOOLEAN;
+            case 'n':
+                return JSON_TYPE::NULL_VALUE;
+            case '\0':
+                if (in.at_end()) {
+                    return JSON_TYPE::END;
                 }
-                case TYPE_CODE::POINTER: {
-                    // explicitly set pointer types to null during deserialization
-                    void** ptr = reinterpret_cast<void**>(reinterpret_cast<char*>(obj) + field.offset);
-                    *ptr = nullptr;
-                    break;
+                break;
+            default:
+                if (c == '-' || (c >= '0' && c <= '9')) {
+                    return JSON_TYPE::NUMBER;
                 }
-                case TYPE_CODE::STRUCT: {
-                    // handle nested struct
-                    void* struct_ptr = reinterpret_cast<void*>(reinterpret_cast<char*>(obj) + field.offset);
+                break;
+        }
+        in.fail("unexpected character");
+    }
+
+    // position in the text
+    size_t offset() const {
+        return in.offset();
+    }
+
+    // enter the object at the cursor, its members are then visited with next_member
+    void begin_object() {
+        in.expect('{');
+        after_open = true;
+    }
+
+    // move to the next member of the current object and read its key, the cursor is left on the member value
+    // returns false once the closing brace has been consumed
+    bool next_member(std::string_view& key) {
+        if (!next_item('}')) {
+            return false;
+        }
+        key = in.read_string(scratch);
+        in.expect(':');
+        return true;
+    }
+
+    // enter the array at the cursor, its elements are then visited with next_element
+    void begin_array() {
+        in.expect('[');
+        after_open = true;
+    }
+
+    // move to the next element of the current array, returns false once the closing bracket has been consumed
+    bool next_element() {
+        return next_item(']');
+    }
+
+    std::string_view read_string() {
+        if (in.peek() != '"') {
+            in.fail("expected string");
+        }
+        return in.read_string(scratch);
+    }
+
+    long long read_integer() {
+        if (type() != JSON_TYPE::NUMBER) {
+            in.fail("expected number");
+        }
+        long long value = 0;
+        switch (in.read_integer(TYPE_CODE::LONG_LONG, &value)) {
+            case detail::integer_status::STORED:
+                return value;
+            case detail::integer_status::OUT_OF_RANGE:
+                in.fail("integer out of range");
+            default:
+                in.fail("expected integer");
+        }
+    }
 
-                    // dynamically call from_json based on struct type name
-                    if (field.struct_type_name && *field.struct_type_name) {
-                        // get metadata for struct type
-                        const auto* struct_metadata = MetadataManager::get_metadata(field.struct_type_name);
-                        if (struct_metadata) {
-                            // check if field exists in JSON and is not null
-                            if (j.find(field.name) != j.end() && !j[field.name].is_null()) {
-                                ::jston::from_json(*struct_metadata, j[field.name], struct_ptr);
-                            }
-                        }
-                    }
-                    break;
-                }
-                case TYPE_CODE::ARRAY: {
-                    // handle array
-                    if (!j.contains(field.name) || !j[field.name].is_array()) {
-                        continue;
-                    }
+    double read_double() {
+        if (type() != JSON_TYPE::NUMBER) {
+            in.fail("expected number");
+        }
+        double value = 0;
+        if (!detail::parse_floating(in.read_number().text, value)) {
+            in.fail("number out of range");
+        }
+        return value;
+    }
 
-                    void* array_ptr = reinterpret_cast<void*>(reinterpret_cast<char*>(obj) + field.offset);
+    bool read_bool() {
+        if (type() != JSON_TYPE::BOOLEAN) {
+            in.fail("expected boolean");
+        }
+        return in.read_bool();
+    }
 
-                    const auto& json_array = j[field.name];
+    // consume a null if the cursor is on one
+    bool read_null() {
+        return in.consume_null();
+    }
 
-                    // first try as struct array
-                    if (field.struct_type_name && *field.struct_type_name) {
-                        // get metadata for struct type
-                        const auto* struct_metadata = MetadataManager::get_metadata(field.struct_type_name);
-                        if (struct_metadata) {
-                            // prefer to use precomputed element_size and array_length
-                            size_t element_size = field.element_size > 0 ? field.element_size : 0;
+    // skip the value at the cursor without decoding it
+    void skip() {
+        in.skip_value();
+    }
 
-                            // iterate through each element in array
-                            for (size_t i = 0; i < json_array.size(); ++i) {
-                                void* element_ptr = static_cast<char*>(array_ptr) + i * element_size;
-                                if (i < static_cast<size_t>(json_array.size())) {
-                                    ::jston::from_json(*struct_metadata, json_array[i], element_ptr);
-                                }
-                            }
-                        }
-                    } else {
-                        if (field.sub_type_code == TYPE_CODE::DOUBLE) {
-                            double* double_array = static_cast<double*>(array_ptr);
-                            int array_size;
-                            if (field.array_length > 0) {
-                                array_size =
-                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
-                            } else {
-                                array_size = std::min(static_cast<int>(json_array.size()),
-                                                      static_cast<int>(field.size / sizeof(double)));
-                            }
-                            for (int i = 0; i < array_size; ++i) {
-                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number()) {
-                                    double_array[i] = json_array[i].get<double>();
-                                }
-                            }
-                        } else if (field.sub_type_code == TYPE_CODE::FLOAT) {
-                            float* float_array = static_cast<float*>(array_ptr);
-                            int array_size;
-                            if (field.array_length > 0) {
-                                array_size =
-                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
-                            } else {
-                                array_size = std::min(static_cast<int>(json_array.size()),
-                                                      static_cast<int>(field.size / sizeof(float)));
-                            }
-                            for (int i = 0; i < array_size; ++i) {
-                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number()) {
-                                    float_array[i] = json_array[i].get<float>();
-                                }
-                            }
-                        } else if (field.sub_type_code == TYPE_CODE::LONG_LONG) {
-                            long long* longlong_array = static_cast<long long*>(array_ptr);
-                            int array_size;
-                            if (field.array_length > 0) {
-                                array_size =
-                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
-                            } else {
-                                array_size = std::min(static_cast<int>(json_array.size()),
-                                                      static_cast<int>(field.size / sizeof(long long)));
-                            }
-                            for (int i = 0; i < array_size; ++i) {
-                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number_integer()) {
-                                    longlong_array[i] = json_array[i].get<long long>();
-                                }
-                            }
-                        } else if (field.sub_type_code == TYPE_CODE::LONG) {
-                            long* long_array = static_cast<long*>(array_ptr);
-                            int array_size;
-                            if (field.array_length > 0) {
-                                array_size =
-                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
-                            } else {
-                                array_size = std::min(static_cast<int>(json_array.size()),
-                                                      static_cast<int>(field.size / sizeof(long)));
-                            }
-                            for (int i = 0; i < array_size; ++i) {
-                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number_integer()) {
-                                    long_array[i] = json_array[i].get<long>();
-                                }
-                            }
-                        } else if (field.sub_type_code == TYPE_CODE::INT) {
-                            int* int_array = static_cast<int*>(array_ptr);
-                            int array_size;
-                            if (field.array_length > 0) {
-                                array_size =
-                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
-                            } else {
-                                array_size = std::min(static_cast<int>(json_array.size()),
-                                                      static_cast<int>(field.size / sizeof(int)));
-                            }
-                            for (int i = 0; i < array_size; ++i) {
-                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number_integer()) {
-                                    int_array[i] = json_array[i].get<int>();
-                                }
-                            }
-                        } else if (field.sub_type_code == TYPE_CODE::SHORT) {
-                            short* short_array = static_cast<short*>(array_ptr);
-                            int array_size;
-                            if (field.array_length > 0) {
-                                array_size =
-                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
-                            } else {
-                                array_size = std::min(static_cast<int>(json_array.size()),
-                                                      static_cast<int>(field.size / sizeof(short)));
-                            }
-                            for (int i = 0; i < array_size; ++i) {
-                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number_integer()) {
-                                    short_array[i] = json_array[i].get<short>();
-                                }
-                            }
-                        } else if (field.sub_type_code == TYPE_CODE::U_INT) {
-                            unsigned int* uint_array = static_cast<unsigned int*>(array_ptr);
-                            int array_size;
-                            if (field.array_length > 0) {
-                                array_size =
-                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
-                            } else {
-                                array_size = std::min(static_cast<int>(json_array.size()),
-                                                      static_cast<int>(field.size / sizeof(unsigned int)));
-                            }
-                            for (int i = 0; i < array_size; ++i) {
-                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number_unsigned()) {
-                                    uint_array[i] = json_array[i].get<unsigned int>();
-                                }
-                            }
-                        } else if (field.sub_type_code == TYPE_CODE::U_SHORT) {
-                            unsigned short* ushort_array = static_cast<unsigned short*>(array_ptr);
-                            int array_size;
-                            if (field.array_length > 0) {
-                                array_size =
-                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
-                            } else {
-                                array_size = std::min(static_cast<int>(json_array.size()),
-                                                      static_cast<int>(field.size / sizeof(unsigned short)));
-                            }
-                            for (int i = 0; i < array_size; ++i) {
-                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_number_unsigned()) {
-                                    ushort_array[i] = json_array[i].get<unsigned short>();
-                                }
-                            }
-                        } else if (field.sub_type_code == TYPE_CODE::BOOL) {
-                            bool* bool_array = static_cast<bool*>(array_ptr);
-                            int array_size;
-                            if (field.array_length > 0) {
-                                array_size =
-                                    std::min(static_cast<int>(json_array.size()), static_cast<int>(field.array_length));
-                            } else {
-                                array_size = std::min(static_cast<int>(json_array.size()),
-                                                      static_cast<int>(field.size / sizeof(bool)));
-                            }
-                            for (int i = 0; i < array_size; ++i) {
-                                if (i < static_cast<int>(json_array.size()) && json_array[i].is_boolean()) {
-                                    bool_array[i] = json_array[i].get<bool>();
-                                }
-                            }
-                        } else {
-                            // unrecognized basic type array
-                            std::cerr << "Error: Unknown basic type array for field '" << field.name << "'"
-                                      << std::endl;
-                        }
-                    }
-                } break;
-                default:
-                    break;
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "Error parsing field '" << field.name << "': " << e.what() << std::endl;
+    // the text of the value at the cursor, which is skipped
+    std::string_view raw() {
+        in.peek();
+        const size_t start = in.offset();
+        in.skip_value();
+        return text.substr(start, in.offset() - start);
+    }
+
+    // decode the object at the cursor into a registered struct, unknown members are skipped
+    template <typename T>
+    void decode_into(T& obj) {
+        JSTON_STATS_SCOPE();
+        JSTON_METRICS_SCOPE(T, decode);
+        if (in.peek() != '{') {
+            in.fail("JSON value is not an object, cannot convert to struct");
         }
+        [[maybe_unused]] const size_t start = in.offset();  // only read by the metrics
+        detail::decode_struct(detail::key_index_of<T>(), in, &obj, nullptr, false);
+        JSTON_METRICS_BYTES(in.offset() - start);
     }
-}
+
+    // decode only the fields selected by the mask, the rest of the object is skipped
+    template <typename T>
+    void decode_into(T& obj, const field_mask& mask) {
+        JSTON_STATS_SCOPE();
+        JSTON_METRICS_SCOPE(T, decode);
+        if (in.peek() != '{') {
+            in.fail("JSON value is not an object, cannot convert to struct");
+        }
+        [[maybe_unused]] const size_t start = in.offset();  // only read by the metrics
+        detail::decode_struct(detail::key_index_of<T>(), in, &obj, &mask, false);
+        JSTON_METRICS_BYTES(in.offset() - start);
+    }
+
+    // true when only whitespace is left
+    bool at_end() {
+        return in.at_end();
+    }
+};
 
 // macro for adding basic type field metadata
 #define STRUCT_TRANSLATOR_ADD_FIELD(field_list, struct_name, type, name)                                               \
@@ -952,6 +6825,14 @@ inline void from_json(const std::vector<field_metadata>& metadata, const nlohman
             field_metadata.sub_type_code = jston::TYPE_CODE::U_INT;                                                    \
         } else if (std::is_same<ARRAY_ELEMENT_TYPE, unsigned short>::value) {                                          \
             field_metadata.sub_type_code = jston::TYPE_CODE::U_SHORT;                                                  \
+        } else if (std::is_same<ARRAY_ELEMENT_TYPE, unsigned long>::value) {                                           \
+            field_metadata.sub_type_code = jston::TYPE_CODE::U_LONG;                                                   \
+        } else if (std::is_same<ARRAY_ELEMENT_TYPE, unsigned long long>::value) {                                      \
+            field_metadata.sub_type_code = jston::TYPE_CODE::U_LONG_LONG;                                              \
+        } else if (std::is_same<ARRAY_ELEMENT_TYPE, signed char>::value) {                                             \
+            field_metadata.sub_type_code = jston::TYPE_CODE::S_CHAR;                                                   \
+        } else if (std::is_same<ARRAY_ELEMENT_TYPE, unsigned char>::value) {                                           \
+            field_metadata.sub_type_code = jston::TYPE_CODE::U_CHAR;                                                   \
         } else if (std::is_same<ARRAY_ELEMENT_TYPE, bool>::value) {                                                    \
             field_metadata.sub_type_code = jston::TYPE_CODE::BOOL;                                                     \
         } else {                                                                                                       \
@@ -968,256 +6849,226 @@ inline void from_json(const std::vector<field_metadata>& metadata, const nlohman
         field_list.push_back(field_metadata);                                                                          \
     } while (0)
 
-// auxiliary macro: handle fields in variable parameter list
-#define _REGISTER_FIELD_IMPL(field_list, struct_name, field_name)                                                      \
-    do {                                                                                                               \
-        jston::field_metadata field_metadata;                                                                          \
-        field_metadata.name = #field_name;                                                                             \
-        field_metadata.type_code = jston::get_type_code<decltype(struct_name::field_name)>();                          \
-        field_metadata.offset = offsetof(struct_name, field_name);                                                     \
-        field_metadata.size = sizeof(struct_name::field_name);                                                         \
-        field_metadata.sub_type_code = jston::TYPE_CODE::UNKNOWN;                                                      \
-        field_metadata.struct_type_name = nullptr;                                                                     \
-                                                                                                                       \
-        if (std::is_array<decltype(struct_name::field_name)>::value) {                                                 \
-            if (!std::is_same<typename std::remove_extent<decltype(struct_name::field_name)>::type, char>::value) {    \
-                field_metadata.type_code = jston::TYPE_CODE::ARRAY;                                                    \
-                /* calculate array element size and array length */                                                    \
-                field_metadata.element_size =                                                                          \
-                    sizeof(typename std::remove_extent<decltype(struct_name::field_name)>::type);                      \
-                field_metadata.array_length = std::extent<decltype(struct_name::field_name)>::value;                   \
-            }                                                                                                          \
-            using ARRAY_ELEMENT_TYPE = typename std::remove_extent<decltype(struct_name::field_name)>::type;           \
-            if (std::is_same<ARRAY_ELEMENT_TYPE, int>::value) {                                                        \
-                field_metadata.sub_type_code = jston::TYPE_CODE::INT;                                                  \
-                field_metadata.struct_type_name = nullptr;                                                             \
-            } else if (std::is_same<ARRAY_ELEMENT_TYPE, double>::value) {                                              \
-                field_metadata.sub_type_code = jston::TYPE_CODE::DOUBLE;                                               \
-                field_metadata.struct_type_name = nullptr;                                                             \
-            } else if (std::is_same<ARRAY_ELEMENT_TYPE, float>::value) {                                               \
-                field_metadata.sub_type_code = jston::TYPE_CODE::FLOAT;                                                \
-                field_metadata.struct_type_name = nullptr;                                                             \
-            } else if (std::is_same<ARRAY_ELEMENT_TYPE, long>::value) {                                                \
-                field_metadata.sub_type_code = jston::TYPE_CODE::LONG;                                                 \
-                field_metadata.struct_type_name = nullptr;                                                             \
-            } else if (std::is_same<ARRAY_ELEMENT_TYPE, long long>::value) {                                           \
-                field_metadata.sub_type_code = jston::TYPE_CODE::LONG_LONG;                                            \
-                field_metadata.struct_type_name = nullptr;                                                             \
-            } else if (std::is_same<ARRAY_ELEMENT_TYPE, short>::value) {                                               \
-                field_metadata.sub_type_code = jston::TYPE_CODE::SHORT;                                                \
-                field_metadata.struct_type_name = nullptr;                                                             \
-            } else if (std::is_same<ARRAY_ELEMENT_TYPE, unsigned int>::value) {                                        \
-                field_metadata.sub_type_code = jston::TYPE_CODE::U_INT;                                                \
-                field_metadata.struct_type_name = nullptr;                                                             \
-            } else if (std::is_same<ARRAY_ELEMENT_TYPE, unsigned short>::value) {                                      \
-                field_metadata.sub_type_code = jston::TYPE_CODE::U_SHORT;                                              \
-                field_metadata.struct_type_name = nullptr;                                                             \
-            } else if (std::is_same<ARRAY_ELEMENT_TYPE, bool>::value) {                                                \
-                field_metadata.sub_type_code = jston::TYPE_CODE::BOOL;                                                 \
-                field_metadata.struct_type_name = nullptr;                                                             \
-            } else {                                                                                                   \
-                field_metadata.sub_type_code = jston::TYPE_CODE::UNKNOWN;                                              \
-                if (jston::get_type_code<ARRAY_ELEMENT_TYPE>() == jston::TYPE_CODE::STRUCT) {                          \
-                    field_metadata.struct_type_name = typeid(ARRAY_ELEMENT_TYPE).name();                               \
-                } else {                                                                                               \
-                    field_metadata.struct_type_name = nullptr; /* Unknown type array */                                \
-                }                                                                                                      \
-            }                                                                                                          \
-        } else if (field_metadata.type_code == jston::TYPE_CODE::STRUCT) {                                             \
-            field_metadata.struct_type_name = typeid(decltype(struct_name::field_name)).name();                        \
-        } else {                                                                                                       \
-            field_metadata.struct_type_name = nullptr;                                                                 \
-        }                                                                                                              \
-        field_list.push_back(field_metadata);                                                                          \
-    } while (0)
+// auxiliary macros: detect a parenthesized field spec such as (cars, car_count)
+#define _JSTON_IS_PAREN(spec) _JSTON_IS_PAREN_CHECK(_JSTON_IS_PAREN_PROBE spec)
+#define _JSTON_IS_PAREN_PROBE(...) ~, 1,
+#define _JSTON_IS_PAREN_CHECK(...) _JSTON_IS_PAREN_SELECT(__VA_ARGS__, 0, ~)
+#define _JSTON_IS_PAREN_SELECT(probe, result, ...) result
+#define _JSTON_CONCAT(a, b) _JSTON_CONCAT_IMPL(a, b)
+#define _JSTON_CONCAT_IMPL(a, b) a##b
+#define _JSTON_UNPAREN(...) __VA_ARGS__
+
+// auxiliary macros: detect the byte array format keywords base64 / hex in a field spec
+#define _JSTON_IS_BYTES_FORMAT(word) _JSTON_IS_PAREN_CHECK(_JSTON_CONCAT_IMPL(_JSTON_BYTES_FORMAT_PROBE_, word))
+#define _JSTON_BYTES_FORMAT_PROBE_base64 ~, 1,
+#define _JSTON_BYTES_FORMAT_PROBE_hex ~, 1,
+#define _JSTON_BYTES_FORMAT_base64 jston::BYTES_FORMAT::BASE64
+#define _JSTON_BYTES_FORMAT_hex jston::BYTES_FORMAT::HEX
+
+// auxiliary macro: metadata initializer of one field in variable parameter list, either a plain field name or a
+// parenthesized spec: (array, count) binds a fixed array to the sibling member that holds its live length,
+// (bytes, base64) / (bytes, hex) emits a byte array as one string, and (bytes, count, base64) does both
+#define _REGISTER_FIELD_IMPL(struct_name, field_spec)                                                                  \
+    _JSTON_CONCAT(_REGISTER_FIELD_SPEC_, _JSTON_IS_PAREN(field_spec))(struct_name, field_spec)
+#define _REGISTER_FIELD_SPEC_0(struct_name, field_name)                                                                \
+    jston::make_field_metadata<decltype(struct_name::field_name)>(#field_name, offsetof(struct_name, field_name))
+#define _REGISTER_FIELD_SPEC_1(struct_name, field_spec)                                                                \
+    _REGISTER_COUNTED_FIELD(struct_name, _JSTON_UNPAREN field_spec)
+#define _REGISTER_COUNTED_FIELD(...) _JSTON_CONCAT(_REGISTER_FIELD_SPEC_ARGS_, _COUNT_ARGS(__VA_ARGS__))(__VA_ARGS__)
+#define _REGISTER_FIELD_SPEC_ARGS_3(struct_name, field_name, option)                                                   \
+    _JSTON_CONCAT(_REGISTER_FIELD_OPTION_, _JSTON_IS_BYTES_FORMAT(option))(struct_name, field_name, option)
+#define _REGISTER_FIELD_SPEC_ARGS_4(struct_name, field_name, count_name, format)                                       \
+    jston::with_bytes_format<decltype(struct_name::field_name)>(                                                       \
+        _REGISTER_COUNTED_FIELD_IMPL(struct_name, field_name, count_name), _JSTON_BYTES_FORMAT_##format)
+#define _REGISTER_FIELD_OPTION_0(struct_name, field_name, count_name)                                                  \
+    _REGISTER_COUNTED_FIELD_IMPL(struct_name, field_name, count_name)
+#define _REGISTER_FIELD_OPTION_1(struct_name, field_name, format)                                                      \
+    jston::with_bytes_format<decltype(struct_name::field_name)>(_REGISTER_FIELD_SPEC_0(struct_name, field_name),       \
+                                                                _JSTON_BYTES_FORMAT_##format)
+#define _REGISTER_COUNTED_FIELD_IMPL(struct_name, field_name, count_name)                                              \
+    jston::make_counted_field_metadata<decltype(struct_name::field_name), decltype(struct_name::count_name)>(          \
+        #field_name, offsetof(struct_name, field_name), offsetof(struct_name, count_name))
+
+// field registration macros (multiple versions for different field counts), expanding to a comma separated list of
+// field metadata initializers
+#define _REGISTER_FIELDS_1(struct_name, field1) _REGISTER_FIELD_IMPL(struct_name, field1)
+
+#define _REGISTER_FIELDS_2(struct_name, field1, field2)                                                                \
+    _REGISTER_FIELDS_1(struct_name, field1),                                                                           \
+    _REGISTER_FIELD_IMPL(struct_name, field2)
+
+#define _REGISTER_FIELDS_3(struct_name, field1, field2, field3)                                                        \
+    _REGISTER_FIELDS_2(struct_name, field1, field2),                                                                   \
+    _REGISTER_FIELD_IMPL(struct_name, field3)
+
+#define _REGISTER_FIELDS_4(struct_name, field1, field2, field3, field4)                                                \
+    _REGISTER_FIELDS_3(struct_name, field1, field2, field3),                                                           \
+    _REGISTER_FIELD_IMPL(struct_name, field4)
+
+#define _REGISTER_FIELDS_5(struct_name, field1, field2, field3, field4, field5)                                        \
+    _REGISTER_FIELDS_4(struct_name, field1, field2, field3, field4),                                                   \
+    _REGISTER_FIELD_IMPL(struct_name, field5)
+
+#define _REGISTER_FIELDS_6(struct_name, field1, field2, field3, field4, field5, field6)                                \
+    _REGISTER_FIELDS_5(struct_name, field1, field2, field3, field4, field5),                                           \
+    _REGISTER_FIELD_IMPL(struct_name, field6)
+
+#define _REGISTER_FIELDS_7(struct_name, field1, field2, field3, field4, field5, field6, field7)                        \
+    _REGISTER_FIELDS_6(struct_name, field1, field2, field3, field4, field5, field6),                                   \
+    _REGISTER_FIELD_IMPL(struct_name, field7)
+
+#define _REGISTER_FIELDS_8(struct_name, field1, field2, field3, field4, field5, field6, field7, field8)                \
+    _REGISTER_FIELDS_7(struct_name, field1, field2, field3, field4, field5, field6, field7),                           \
+    _REGISTER_FIELD_IMPL(struct_name, field8)
+
+#define _REGISTER_FIELDS_9(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9)        \
+    _REGISTER_FIELDS_8(struct_name, field1, field2, field3, field4, field5, field6, field7, field8),                   \
+    _REGISTER_FIELD_IMPL(struct_name, field9)
 
-// field registration macros (multiple versions for different field counts)
-#define _REGISTER_FIELDS_1(field_list, struct_name, field1) _REGISTER_FIELD_IMPL(field_list, struct_name, field1)
-
-#define _REGISTER_FIELDS_2(field_list, struct_name, field1, field2)                                                    \
-    _REGISTER_FIELDS_1(field_list, struct_name, field1);                                                               \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field2)
-
-#define _REGISTER_FIELDS_3(field_list, struct_name, field1, field2, field3)                                            \
-    _REGISTER_FIELDS_2(field_list, struct_name, field1, field2);                                                       \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field3);
-
-#define _REGISTER_FIELDS_4(field_list, struct_name, field1, field2, field3, field4)                                    \
-    _REGISTER_FIELDS_3(field_list, struct_name, field1, field2, field3);                                               \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field4)
-
-#define _REGISTER_FIELDS_5(field_list, struct_name, field1, field2, field3, field4, field5)                            \
-    _REGISTER_FIELDS_4(field_list, struct_name, field1, field2, field3, field4);                                       \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field5)
-
-#define _REGISTER_FIELDS_6(field_list, struct_name, field1, field2, field3, field4, field5, field6)                    \
-    _REGISTER_FIELDS_5(field_list, struct_name, field1, field2, field3, field4, field5);                               \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field6)
-
-#define _REGISTER_FIELDS_7(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7)            \
-    _REGISTER_FIELDS_6(field_list, struct_name, field1, field2, field3, field4, field5, field6);                       \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field7)
-
-#define _REGISTER_FIELDS_8(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8)    \
-    _REGISTER_FIELDS_7(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7);               \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field8)
-
-#define _REGISTER_FIELDS_9(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,    \
-                           field9)                                                                                     \
-    _REGISTER_FIELDS_8(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8);       \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field9)
-
-#define _REGISTER_FIELDS_10(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10)                                                                           \
-    _REGISTER_FIELDS_9(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,        \
-                       field9);                                                                                        \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field10)
-
-#define _REGISTER_FIELDS_11(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11)                                                                  \
-    _REGISTER_FIELDS_10(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10);                                                                              \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field11)
-
-#define _REGISTER_FIELDS_12(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12)                                                         \
-    _REGISTER_FIELDS_11(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11);                                                                     \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field12)
-
-#define _REGISTER_FIELDS_13(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13)                                                \
-    _REGISTER_FIELDS_12(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12);                                                            \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field13)
-
-#define _REGISTER_FIELDS_14(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14)                                       \
-    _REGISTER_FIELDS_13(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13);                                                   \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field14)
-
-#define _REGISTER_FIELDS_15(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15)                              \
-    _REGISTER_FIELDS_14(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14);                                          \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field15)
-
-#define _REGISTER_FIELDS_16(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16)                     \
-    _REGISTER_FIELDS_15(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15);                                 \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field16)
-
-#define _REGISTER_FIELDS_17(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17)            \
-    _REGISTER_FIELDS_16(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16);                        \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field17)
-
-#define _REGISTER_FIELDS_18(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17, field18)   \
-    _REGISTER_FIELDS_17(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16, field17);               \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field18)
-
-#define _REGISTER_FIELDS_19(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,   \
-                            field19)                                                                                   \
-    _REGISTER_FIELDS_18(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16, field17, field18);      \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field19)
-
-#define _REGISTER_FIELDS_20(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,   \
-                            field19, field20)                                                                          \
-    _REGISTER_FIELDS_19(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,       \
-                        field19);                                                                                      \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field20)
-
-#define _REGISTER_FIELDS_21(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,   \
-                            field19, field20, field21)                                                                 \
-    _REGISTER_FIELDS_20(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,       \
-                        field19, field20);                                                                             \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field21)
-
-#define _REGISTER_FIELDS_22(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,   \
-                            field19, field20, field21, field22)                                                        \
-    _REGISTER_FIELDS_21(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,       \
-                        field19, field20, field21);                                                                    \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field22)
-
-#define _REGISTER_FIELDS_23(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,   \
-                            field19, field20, field21, field22, field23)                                               \
-    _REGISTER_FIELDS_22(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,       \
-                        field19, field20, field21, field22);                                                           \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field23)
-
-#define _REGISTER_FIELDS_24(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,   \
-                            field19, field20, field21, field22, field23, field24)                                      \
-    _REGISTER_FIELDS_23(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,       \
-                        field19, field20, field21, field22, field23);                                                  \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field24)
-
-#define _REGISTER_FIELDS_25(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,   \
-                            field19, field20, field21, field22, field23, field24, field25)                             \
-    _REGISTER_FIELDS_24(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,       \
-                        field19, field20, field21, field22, field23, field24);                                         \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field25)
-
-#define _REGISTER_FIELDS_26(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,   \
-                            field19, field20, field21, field22, field23, field24, field25, field26)                    \
-    _REGISTER_FIELDS_25(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,       \
-                        field19, field20, field21, field22, field23, field24, field25);                                \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field26)
-
-#define _REGISTER_FIELDS_27(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,   \
-                            field19, field20, field21, field22, field23, field24, field25, field26, field27)           \
-    _REGISTER_FIELDS_26(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,       \
-                        field19, field20, field21, field22, field23, field24, field25, field26);                       \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field27)
-
-#define _REGISTER_FIELDS_28(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,   \
-                            field19, field20, field21, field22, field23, field24, field25, field26, field27, field28)  \
-    _REGISTER_FIELDS_27(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,       \
-                        field19, field20, field21, field22, field23, field24, field25, field26, field27);              \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field28)
-
-#define _REGISTER_FIELDS_29(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,   \
-                            field19, field20, field21, field22, field23, field24, field25, field26, field27, field28,  \
-                            field29)                                                                                   \
-    _REGISTER_FIELDS_28(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,       \
-                        field19, field20, field21, field22, field23, field24, field25, field26, field27, field28);     \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field29)
-
-#define _REGISTER_FIELDS_30(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,   \
-                            field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,   \
-                            field19, field20, field21, field22, field23, field24, field25, field26, field27, field28,  \
-                            field29, field30)                                                                          \
-    _REGISTER_FIELDS_29(field_list, struct_name, field1, field2, field3, field4, field5, field6, field7, field8,       \
-                        field9, field10, field11, field12, field13, field14, field15, field16, field17, field18,       \
-                        field19, field20, field21, field22, field23, field24, field25, field26, field27, field28,      \
-                        field29);                                                                                      \
-    _REGISTER_FIELD_IMPL(field_list, struct_name, field30)
+#define _REGISTER_FIELDS_10(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10)                                                                                   \
+    _REGISTER_FIELDS_9(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9),           \
+    _REGISTER_FIELD_IMPL(struct_name, field10)
+
+#define _REGISTER_FIELDS_11(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11)                                                                          \
+    _REGISTER_FIELDS_10(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10), \
+    _REGISTER_FIELD_IMPL(struct_name, field11)
+
+#define _REGISTER_FIELDS_12(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12)                                                                 \
+    _REGISTER_FIELDS_11(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11),                                                                                      \
+    _REGISTER_FIELD_IMPL(struct_name, field12)
+
+#define _REGISTER_FIELDS_13(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13)                                                        \
+    _REGISTER_FIELDS_12(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12),                                                                             \
+    _REGISTER_FIELD_IMPL(struct_name, field13)
+
+#define _REGISTER_FIELDS_14(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14)                                               \
+    _REGISTER_FIELDS_13(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13),                                                                    \
+    _REGISTER_FIELD_IMPL(struct_name, field14)
+
+#define _REGISTER_FIELDS_15(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15)                                      \
+    _REGISTER_FIELDS_14(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14),                                                           \
+    _REGISTER_FIELD_IMPL(struct_name, field15)
+
+#define _REGISTER_FIELDS_16(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16)                             \
+    _REGISTER_FIELDS_15(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15),                                                  \
+    _REGISTER_FIELD_IMPL(struct_name, field16)
+
+#define _REGISTER_FIELDS_17(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17)                    \
+    _REGISTER_FIELDS_16(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16),                                         \
+    _REGISTER_FIELD_IMPL(struct_name, field17)
+
+#define _REGISTER_FIELDS_18(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17, field18)           \
+    _REGISTER_FIELDS_17(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16, field17),                                \
+    _REGISTER_FIELD_IMPL(struct_name, field18)
+
+#define _REGISTER_FIELDS_19(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17, field18, field19)  \
+    _REGISTER_FIELDS_18(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16, field17, field18),                       \
+    _REGISTER_FIELD_IMPL(struct_name, field19)
+
+#define _REGISTER_FIELDS_20(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17, field18, field19,  \
+                            field20)                                                                                   \
+    _REGISTER_FIELDS_19(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16, field17, field18, field19),              \
+    _REGISTER_FIELD_IMPL(struct_name, field20)
+
+#define _REGISTER_FIELDS_21(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17, field18, field19,  \
+                            field20, field21)                                                                          \
+    _REGISTER_FIELDS_20(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16, field17, field18, field19, field20),     \
+    _REGISTER_FIELD_IMPL(struct_name, field21)
+
+#define _REGISTER_FIELDS_22(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17, field18, field19,  \
+                            field20, field21, field22)                                                                 \
+    _REGISTER_FIELDS_21(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16, field17, field18, field19, field20,      \
+                        field21),                                                                                      \
+    _REGISTER_FIELD_IMPL(struct_name, field22)
+
+#define _REGISTER_FIELDS_23(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17, field18, field19,  \
+                            field20, field21, field22, field23)                                                        \
+    _REGISTER_FIELDS_22(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16, field17, field18, field19, field20,      \
+                        field21, field22),                                                                             \
+    _REGISTER_FIELD_IMPL(struct_name, field23)
+
+#define _REGISTER_FIELDS_24(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17, field18, field19,  \
+                            field20, field21, field22, field23, field24)                                               \
+    _REGISTER_FIELDS_23(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16, field17, field18, field19, field20,      \
+                        field21, field22, field23),                                                                    \
+    _REGISTER_FIELD_IMPL(struct_name, field24)
+
+#define _REGISTER_FIELDS_25(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17, field18, field19,  \
+                            field20, field21, field22, field23, field24, field25)                                      \
+    _REGISTER_FIELDS_24(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16, field17, field18, field19, field20,      \
+                        field21, field22, field23, field24),                                                           \
+    _REGISTER_FIELD_IMPL(struct_name, field25)
+
+#define _REGISTER_FIELDS_26(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17, field18, field19,  \
+                            field20, field21, field22, field23, field24, field25, field26)                             \
+    _REGISTER_FIELDS_25(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16, field17, field18, field19, field20,      \
+                        field21, field22, field23, field24, field25),                                                  \
+    _REGISTER_FIELD_IMPL(struct_name, field26)
+
+#define _REGISTER_FIELDS_27(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17, field18, field19,  \
+                            field20, field21, field22, field23, field24, field25, field26, field27)                    \
+    _REGISTER_FIELDS_26(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16, field17, field18, field19, field20,      \
+                        field21, field22, field23, field24, field25, field26),                                         \
+    _REGISTER_FIELD_IMPL(struct_name, field27)
+
+#define _REGISTER_FIELDS_28(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17, field18, field19,  \
+                            field20, field21, field22, field23, field24, field25, field26, field27, field28)           \
+    _REGISTER_FIELDS_27(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16, field17, field18, field19, field20,      \
+                        field21, field22, field23, field24, field25, field26, field27),                                \
+    _REGISTER_FIELD_IMPL(struct_name, field28)
+
+#define _REGISTER_FIELDS_29(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17, field18, field19,  \
+                            field20, field21, field22, field23, field24, field25, field26, field27, field28, field29)  \
+    _REGISTER_FIELDS_28(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16, field17, field18, field19, field20,      \
+                        field21, field22, field23, field24, field25, field26, field27, field28),                       \
+    _REGISTER_FIELD_IMPL(struct_name, field29)
+
+#define _REGISTER_FIELDS_30(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9,       \
+                            field10, field11, field12, field13, field14, field15, field16, field17, field18, field19,  \
+                            field20, field21, field22, field23, field24, field25, field26, field27, field28, field29,  \
+                            field30)                                                                                   \
+    _REGISTER_FIELDS_29(struct_name, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10,  \
+                        field11, field12, field13, field14, field15, field16, field17, field18, field19, field20,      \
+                        field21, field22, field23, field24, field25, field26, field27, field28, field29),              \
+    _REGISTER_FIELD_IMPL(struct_name, field30)
 
 // parameter counting macros and intermediate macros
 #define _GET_COUNT(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21,     \
@@ -1228,27 +7079,134 @@ inline void from_json(const std::vector<field_metadata>& metadata, const nlohman
                7, 6, 5, 4, 3, 2, 1, 0)
 
 // intermediate macro for connecting macro name and parameter count
-#define _REG_FIELDS_IMPL(N, field_list, struct_name, ...) _REGISTER_FIELDS_##N(field_list, struct_name, __VA_ARGS__)
-#define _REG_FIELDS(N, field_list, struct_name, ...)      _REG_FIELDS_IMPL(N, field_list, struct_name, __VA_ARGS__)
+#define _REG_FIELDS_IMPL(N, struct_name, ...) _REGISTER_FIELDS_##N(struct_name, __VA_ARGS__)
+#define _REG_FIELDS(N, struct_name, ...)      _REG_FIELDS_IMPL(N, struct_name, __VA_ARGS__)
 
 // main field registration macro
-#define REGISTER_FIELDS(field_list, struct_name, ...)                                                                  \
-    _REG_FIELDS(_COUNT_ARGS(__VA_ARGS__), field_list, struct_name, __VA_ARGS__)
+#define REGISTER_FIELDS(struct_name, ...) _REG_FIELDS(_COUNT_ARGS(__VA_ARGS__), struct_name, __VA_ARGS__)
+
+// standard library containers such as std::unordered_map make a struct non-standard-layout, where offsetof is
+// conditionally-supported; GCC and Clang support it for the data members registered here, so the warning is muted
+#if defined(__GNUC__) || defined(__clang__)
+#define _JSTON_OFFSETOF_WARNING_PUSH                                                                                   \
+    _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Winvalid-offsetof\"")
+#define _JSTON_OFFSETOF_WARNING_POP _Pragma("GCC diagnostic pop")
+#else
+#define _JSTON_OFFSETOF_WARNING_PUSH
+#define _JSTON_OFFSETOF_WARNING_POP
+#endif
 
 // define an auxiliary macro for properly handling TypeName
+// registration specializes struct_info with a constexpr field table. the only code it runs at program startup links
+// a constant-initialized node into a list (no allocation, no lock); the type is published to the name registry the
+// first time it is converted (see metadata_of) or looked up by name (see MetadataManager::get_metadata)
 #define _REGISTER_STRUCT_IMPL(TypeName, ...)                                                                           \
+    _JSTON_OFFSETOF_WARNING_PUSH                                                                                       \
     namespace jston {                                                                                                  \
     template <>                                                                                                        \
-    void register_struct_metadata<TypeName>() {                                                                        \
-        std::vector<field_metadata> fields;                                                                            \
-        REGISTER_FIELDS(fields, TypeName, __VA_ARGS__);                                                                \
-        register_metadata_helper<TypeName>(fields);                                                                    \
+    struct struct_info<TypeName> {                                                                                     \
+        static constexpr bool is_registered = true;                                                                    \
+        static constexpr const char* name = #TypeName;                                                                 \
+        static constexpr field_metadata fields[] = {REGISTER_FIELDS(TypeName, __VA_ARGS__)};                           \
+        inline static MetadataManager::pending_type pending{[] { return typeid(TypeName).name(); },                    \
+                                                            &metadata_of<TypeName>, nullptr};                          \
+        inline static const bool linked = MetadataManager::add_pending(pending);                                       \
+    };                                                                                                                 \
     }                                                                                                                  \
-    static AutoRegistrar<TypeName> g_auto_registrar_##TypeName;                                                        \
-    }  // namespace jston
+    _JSTON_OFFSETOF_WARNING_POP
 
 #define register_json_struct(TypeName, ...) _REGISTER_STRUCT_IMPL(TypeName, __VA_ARGS__)
 
+// auxiliary macro: table entry of one enumerator
+#define _REGISTER_ENUMERATOR_IMPL(enum_name, value)                                                                    \
+    jston::enum_entry{#value, static_cast<long long>(enum_name::value)}
+
+// enumerator registration macros (one per enumerator count), expanding to a comma separated list of table entries
+#define _REGISTER_ENUMERATORS_1(enum_name, value) _REGISTER_ENUMERATOR_IMPL(enum_name, value)
+#define _REGISTER_ENUMERATORS_2(enum_name, value, ...)                                                                 \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_1(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_3(enum_name, value, ...)                                                                 \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_2(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_4(enum_name, value, ...)                                                                 \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_3(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_5(enum_name, value, ...)                                                                 \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_4(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_6(enum_name, value, ...)                                                                 \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_5(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_7(enum_name, value, ...)                                                                 \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_6(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_8(enum_name, value, ...)                                                                 \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_7(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_9(enum_name, value, ...)                                                                 \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_8(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_10(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_9(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_11(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_10(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_12(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_11(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_13(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_12(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_14(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_13(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_15(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_14(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_16(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_15(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_17(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_16(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_18(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_17(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_19(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_18(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_20(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_19(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_21(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_20(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_22(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_21(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_23(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_22(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_24(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_23(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_25(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_24(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_26(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_25(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_27(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_26(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_28(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_27(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_29(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_28(enum_name, __VA_ARGS__)
+#define _REGISTER_ENUMERATORS_30(enum_name, value, ...)                                                                \
+    _REGISTER_ENUMERATOR_IMPL(enum_name, value), _REGISTER_ENUMERATORS_29(enum_name, __VA_ARGS__)
+
+// intermediate macros for connecting macro name and enumerator count
+#define _REG_ENUMERATORS_IMPL(N, enum_name, ...) _REGISTER_ENUMERATORS_##N(enum_name, __VA_ARGS__)
+#define _REG_ENUMERATORS(N, enum_name, ...)      _REG_ENUMERATORS_IMPL(N, enum_name, __VA_ARGS__)
+
+// main enumerator registration macro
+#define REGISTER_ENUMERATORS(enum_name, ...) _REG_ENUMERATORS(_COUNT_ARGS(__VA_ARGS__), enum_name, __VA_ARGS__)
+
+// registration only specializes enum_info with a constexpr enumerator table, the name index is built at compile time
+#define _REGISTER_ENUM_IMPL(TypeName, emit_names, ...)                                                                 \
+    namespace jston {                                                                                                  \
+    template <>                                                                                                        \
+    struct enum_info<TypeName> {                                                                                       \
+        static constexpr bool is_registered = true;                                                                    \
+        static constexpr bool as_name = emit_names;                                                                    \
+        static constexpr enum_entry entries[] = {REGISTER_ENUMERATORS(TypeName, __VA_ARGS__)};                         \
+    };                                                                                                                 \
+    }  // namespace jston
+
+// register the enumerators of an enum, its fields are emitted as enumerator names
+#define register_json_enum(TypeName, ...) _REGISTER_ENUM_IMPL(TypeName, true, __VA_ARGS__)
+
+// register the enumerators of an enum, its fields are emitted as integers (the fastest encoding) and decoded from
+// either integers or names
+#define register_json_enum_as_int(TypeName, ...) _REGISTER_ENUM_IMPL(TypeName, false, __VA_ARGS__)
+
 }  // namespace jston
 
 #endif
\ No newline at end of file
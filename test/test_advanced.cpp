@@ -4,9 +4,15 @@
 #include <stdexcept>
 #include <climits>
 #include <cfloat>
+#include <atomic>
 #include <chrono>
+#include <thread>
+#include <vector>
 #include "jston.h"
 
+// count heap allocations made during conversions (this test program is built with JSTON_ENABLE_STATS)
+JSTON_STATS_ALLOCATION_HOOK()
+
 struct Car {
     int id;
     double price;
@@ -293,6 +299,210 @@ void test_performance() {
     }
 }
 
+// test conversion statistics
+void test_conversion_stats() {
+    std::cout << "=== Testing Conversion Statistics ===" << std::endl;
+
+    if (!jston::stats::enabled) {
+        std::cout << "Statistics are disabled, build with JSTON_ENABLE_STATS to enable them" << std::endl;
+        return;
+    }
+
+    Person person;
+    memset(&person, 0, sizeof(person));
+    person.age = 30;
+    strcpy(person.name, "John Doe");
+    strcpy(person.car.brand, "Toyota");
+
+    // encoding builds a DOM, so it allocates
+    jston::stats::reset();
+    nlohmann::json person_json = jston::to_json(person);
+    jston::stats::snapshot_data encode_stats = jston::stats::snapshot();
+    std::cout << "to_json: allocations=" << encode_stats.allocations
+              << ", allocated_bytes=" << encode_stats.allocated_bytes
+              << ", metadata_lookups=" << encode_stats.metadata_lookups
+              << ", fields_encoded=" << encode_stats.fields_encoded << std::endl;
+
+    // decoding from an existing DOM into a struct of fixed-size fields must not allocate
+    jston::stats::reset();
+    Person person_loaded;
+    jston::from_json(person_json, person_loaded);
+    jston::stats::snapshot_data decode_stats = jston::stats::snapshot();
+    std::cout << "from_json: allocations=" << decode_stats.allocations
+              << ", metadata_lookups=" << decode_stats.metadata_lookups
+              << ", fields_decoded=" << decode_stats.fields_decoded << std::endl;
+
+    // registered types reach their metadata without a registry lookup
+    // allocations outside of conversions are not counted
+    jston::stats::reset();
+    std::string unrelated(256, 'x');
+    bool passed = encode_stats.allocations > 0 && encode_stats.fields_encoded == 8 &&
+                  encode_stats.metadata_lookups == 0 && decode_stats.allocations == 0 &&
+                  decode_stats.fields_decoded == 8 && jston::stats::snapshot().allocations == 0;
+    std::cout << (passed ? "Conversion statistics verification passed!" : "Warning: unexpected conversion statistics!")
+              << std::endl;
+}
+
+// test per-type conversion metrics
+void test_conversion_metrics() {
+    std::cout << "=== Testing Per-Type Conversion Metrics ===" << std::endl;
+
+    if (!jston::metrics::enabled) {
+        std::cout << "Metrics are disabled, build with JSTON_ENABLE_METRICS to enable them" << std::endl;
+        return;
+    }
+
+    // earlier tests may already have converted this type, only look at what this test adds
+    auto counter = [](const char* dir, const char* name) -> uint64_t {
+        nlohmann::json metrics_json = jston::metrics::dump_json();
+        if (!metrics_json.contains("SingleFieldStruct") || !metrics_json["SingleFieldStruct"].contains(dir)) {
+            return 0;
+        }
+        return metrics_json["SingleFieldStruct"][dir][name].get<uint64_t>();
+    };
+    const uint64_t encode_calls = counter("encode", "calls");
+    const uint64_t encode_bytes = counter("encode", "bytes");
+    const uint64_t decode_calls = counter("decode", "calls");
+    const uint64_t decode_errors = counter("decode", "errors");
+
+    // conversions on several threads are recorded into separate shards and merged by the dump
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([t] {
+            SingleFieldStruct single;
+            single.only_field = t;
+            for (int i = 0; i < 100; ++i) {
+                std::string text = jston::to_json_string(single);
+                SingleFieldStruct loaded;
+                jston::from_json_string(text, loaded);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // failed conversions are counted as errors
+    try {
+        SingleFieldStruct single;
+        jston::from_json_string("{\"only_field\": ", single);
+    } catch (const std::exception&) {
+    }
+
+    nlohmann::json metrics_json = jston::metrics::dump_json();
+    const nlohmann::json& single_metrics = metrics_json["SingleFieldStruct"];
+    std::cout << "SingleFieldStruct encode: " << single_metrics["encode"]["calls"] << " calls, "
+              << single_metrics["encode"]["bytes"] << " bytes, p50 " << single_metrics["encode"]["p50_ns"] << " ns"
+              << std::endl;
+    std::cout << "SingleFieldStruct decode: " << single_metrics["decode"]["calls"] << " calls, "
+              << single_metrics["decode"]["errors"] << " errors" << std::endl;
+
+    std::string prometheus = jston::metrics::dump_prometheus();
+    const std::string calls_line = "jston_calls_total{type=\"SingleFieldStruct\",direction=\"encode\"} " +
+                                   std::to_string(encode_calls + 400);
+    bool passed = counter("encode", "calls") == encode_calls + 400 &&
+                  counter("encode", "bytes") == encode_bytes + 400 * 16 &&
+                  counter("decode", "calls") == decode_calls + 401 &&
+                  counter("decode", "errors") == decode_errors + 1 && prometheus.find(calls_line) != std::string::npos;
+    std::cout << (passed ? "Conversion metrics verification passed!" : "Warning: unexpected conversion metrics!")
+              << std::endl;
+}
+
+// test metadata registration at runtime while other threads are converting
+void test_concurrent_registration() {
+    std::cout << "=== Testing Concurrent Metadata Registration ===" << std::endl;
+
+    const std::vector<jston::field_metadata> car_metadata = *jston::metadata_of<Car>();
+    const std::vector<jston::field_metadata> person_metadata = *jston::metadata_of<Person>();
+
+    Person person;
+    memset(&person, 0, sizeof(person));
+    person.age = 30;
+    strcpy(person.name, "John Doe");
+    const std::string expected = jston::to_json_string(person);
+
+    // readers keep converting while a writer registers new types (growing the registry) and re-registers Person
+    std::atomic<bool> done{false};
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                const auto* by_name = jston::MetadataManager::get_metadata(typeid(Person).name());
+                if (jston::to_json_string(person) != expected || !by_name ||
+                    by_name->size() != person_metadata.size()) {
+                    mismatches.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 1000; ++i) {
+        jston::MetadataManager::register_metadata("plugin_type_" + std::to_string(i), car_metadata);
+        if (i % 100 == 0) {
+            jston::MetadataManager::register_metadata(typeid(Person).name(), person_metadata);
+        }
+    }
+    done.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    bool passed = mismatches.load() == 0 && jston::MetadataManager::get_metadata("plugin_type_0") &&
+                  jston::MetadataManager::get_metadata("plugin_type_999") &&
+                  jston::MetadataManager::get_metadata("plugin_type_999")->size() == car_metadata.size() &&
+                  !jston::MetadataManager::get_metadata("plugin_type_1000");
+    std::cout << (passed ? "Concurrent registration verification passed!"
+                         : "Warning: concurrent registration produced inconsistent results!")
+              << std::endl;
+}
+
+// test schema-aware validation without decoding
+void test_validation() {
+    std::cout << "=== Testing Validation ===" << std::endl;
+
+    const std::string valid = R"({"age": 30, "name": "Jane \"JD\" Doe", "car": {"id": 7, "price": 2.5e4,
+        "brand": "Honda", "model": null, "extra": [true, {"deep": [-1.5e-3, "é"]}]}, "phone_numbers": [1, 2, 3], "note": {}})";
+    jston::stats::reset();
+    bool passed = jston::validate<Person>(valid) && jston::validate<Person>(valid);
+    const jston::stats::snapshot_data stats = jston::stats::snapshot();
+    std::cout << "Valid payload accepted, allocations=" << stats.allocations << std::endl;
+    passed = passed && stats.allocations == 0;
+
+    const std::string deep = "{\"age\": 1, \"unknown\": " + std::string(2000, '[') + std::string(2000, ']') + "}";
+    const std::string rejected[] = {
+        R"({"age": 3000000000})",
+        R"({"age": 1.5})",
+        R"({"name": "a name that is much longer than thirty-one bytes"})",
+        R"({"phone_numbers": [1, 2, 3, 4, 5, 6]})",
+        R"({"phone_numbers": [1, "2"]})",
+        R"({"car": [1]})",
+        R"({"car": {"brand": 5}})",
+        R"({"age": 1, "unknown": [1, tru]})",
+        R"({"age": 1, "unknown": "bad \x escape"})",
+        R"({"age": 1} trailing)",
+        R"({"age": 1,})",
+        R"([1, 2])",
+        deep,
+    };
+    for (const std::string& json : rejected) {
+        std::string error;
+        if (jston::validate<Person>(json, &error)) {
+            std::cout << "Unexpectedly accepted: " << json << std::endl;
+            passed = false;
+        } else {
+            std::cout << "Rejected: " << error << std::endl;
+        }
+    }
+
+    // numbers are checked against the field type the way the decoder converts them
+    const bool in_range = jston::validate<ExtremeValuesStruct>(R"({"min_int": -2.5e3, "max_float": 3.4e38})");
+    std::string error;
+    const bool float_overflow = jston::validate<ExtremeValuesStruct>(R"({"max_float": 1e39})", &error);
+    std::cout << "Float beyond its range rejected: " << error << std::endl;
+    passed = passed && in_range && !float_overflow;
+    std::cout << (passed ? "Validation verification passed!" : "Warning: unexpected validation result!") << std::endl;
+}
+
 // test error handling
 void test_error_handling() {
     std::cout << "=== Testing Error Handling ===" << std::endl;
@@ -350,6 +560,22 @@ int main() {
     test_performance();
     print_separator();
 
+    // test conversion statistics
+    test_conversion_stats();
+    print_separator();
+
+    // test per-type conversion metrics
+    test_conversion_metrics();
+    print_separator();
+
+    // test metadata registration at runtime while other threads are converting
+    test_concurrent_registration();
+    print_separator();
+
+    // test validation without decoding
+    test_validation();
+    print_separator();
+
     // test error handling
     test_error_handling();
 
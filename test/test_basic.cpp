@@ -1,6 +1,12 @@
 #include <iostream>
 #include <string>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <charconv>
 #include <cstring>
+#include <limits>
 #include "jston.h"
 
 // function pointer type definition
@@ -508,6 +514,1158 @@ void test_struct_with_pointers() {
     }
 }
 
+// test field projection with a compiled field mask
+void test_field_mask() {
+    std::cout << "=== Testing Field Mask Projection ===" << std::endl;
+
+    Company company;
+    memset(&company, 0, sizeof(company));
+    strcpy(company.name, "TechCorp");
+    company.employee_count = 1;
+    company.employees[0].age = 30;
+    strcpy(company.employees[0].name, "John Doe");
+    company.employees[0].car.id = 1001;
+    strcpy(company.employees[0].car.brand, "Toyota");
+
+    try {
+        // select a top-level field and a nested path inside the struct array
+        jston::field_mask mask = jston::parse_field_mask<Company>("name, employees.name,employees.car.brand");
+        nlohmann::json masked_json = jston::to_json(company, mask);
+        std::cout << "Masked Company to JSON:\n" << masked_json["employees"][0].dump(4) << std::endl;
+
+        bool passed = masked_json.size() == 2 && masked_json["name"] == "TechCorp" &&
+                      !masked_json.contains("employee_count") && masked_json["employees"].size() == 10 &&
+                      masked_json["employees"][0].size() == 2 && masked_json["employees"][0]["name"] == "John Doe" &&
+                      masked_json["employees"][0]["car"].size() == 1 &&
+                      masked_json["employees"][0]["car"]["brand"] == "Toyota";
+        std::cout << (passed ? "Field mask projection verification passed!"
+                             : "Warning: field mask projection mismatch!")
+                  << std::endl;
+
+        // a whole subtree selection wins over a partial one
+        jston::field_mask subtree_mask = jston::make_field_mask<Person>({"car.brand", "car"});
+        nlohmann::json person_json = jston::to_json(company.employees[0], subtree_mask);
+        std::cout << "Masked Person to JSON: " << person_json.dump() << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Field mask test failed: " << e.what() << std::endl;
+    }
+
+    // unknown fields are rejected when compiling the mask
+    try {
+        jston::parse_field_mask<Company>("name,employees.salary");
+        std::cout << "This line should not be executed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cout << "Successfully caught invalid mask path: " << e.what() << std::endl;
+    }
+}
+
+// struct registered only for the lazy registration test, never converted before it runs
+struct Point {
+    int x;
+    int y;
+};
+register_json_struct(Point, x, y);
+
+// registration tables are constant-initialized
+static_assert(jston::struct_info<Point>::is_registered, "Point should be registered");
+static_assert(jston::struct_info<Point>::fields[1].offset == offsetof(Point, y), "field table is not constexpr");
+static_assert(jston::struct_info<Person>::fields[2].type_code == jston::TYPE_CODE::STRUCT, "car should be a struct");
+
+// conversions may run from dynamic initializers of other globals, regardless of initialization order
+static const std::string g_startup_car_json = jston::to_json_string(Car{7, 1.5, "Startup", "Static"});
+
+// test registration without static initializers
+void test_lazy_registration() {
+    std::cout << "=== Testing Lazy Registration ===" << std::endl;
+
+    std::cout << "Car converted during static initialization: " << g_startup_car_json << std::endl;
+
+    // a registered type is published to the name registry by a lookup by name, also before its first conversion
+    const auto* by_name = jston::MetadataManager::get_metadata(typeid(Point).name());
+    Point point{3, 4};
+    std::string json_str = jston::to_json_string(point);
+    std::cout << "Point JSON: " << json_str << ", found by name before first use: " << (by_name != nullptr)
+              << std::endl;
+
+    bool passed = by_name && by_name == jston::metadata_of<Point>() && by_name->size() == 2 &&
+                  json_str == R"({"x":3,"y":4})" &&
+                  jston::MetadataManager::get_metadata("no_such_type") == nullptr &&
+                  g_startup_car_json.find("\"brand\":\"Startup\"") != std::string::npos;
+    std::cout << (passed ? "Lazy registration verification passed!" : "Warning: lazy registration mismatch!")
+              << std::endl;
+}
+
+// test that the DOM and the text encoder, both walking the registered field table, produce the same document
+void test_encoder_agreement() {
+    std::cout << "=== Testing Encoder Agreement ===" << std::endl;
+
+    Level1 nested;
+    memset(&nested, 0, sizeof(nested));
+    nested.id = 1;
+    strcpy(nested.name, "Level1");
+    nested.items[1].items[0].items[1].items[2].value = 2.5;
+    strcpy(nested.items[1].items[0].items[1].items[2].name, "deep");
+
+    SystemConfig config;
+    memset(&config, 0, sizeof(config));
+    config.log_level = 3;
+    config.logger = simple_logger;
+
+    StructWithPointers pointers;
+    memset(&pointers, 0, sizeof(pointers));
+    pointers.id = 5;
+
+    const nlohmann::json nested_json = jston::to_json(nested);
+    bool passed = nested_json == nlohmann::json::parse(jston::to_json_string(nested)) &&
+                  jston::to_json(config) == nlohmann::json::parse(jston::to_json_string(config)) &&
+                  jston::to_json(pointers) == nlohmann::json::parse(jston::to_json_string(pointers)) &&
+                  nested_json["items"][1]["items"][0]["items"][1]["items"][2]["name"] == "deep";
+    std::cout << "Level1 document: " << nested_json.dump().size() << " bytes" << std::endl;
+    std::cout << (passed ? "Encoder agreement verification passed!" : "Warning: encoder agreement mismatch!")
+              << std::endl;
+}
+
+// struct with std::string and std::string_view members
+struct Profile {
+    int id;
+    std::string name;
+    std::string_view tag;
+    Car car;
+};
+register_json_struct(Profile, id, name, tag, car);
+
+// trees that reach a std::string_view member only through containers, and one that never does
+struct ProfileTree {
+    std::map<std::string, Profile> members;
+    std::vector<ProfileTree> children;
+};
+register_json_struct(ProfileTree, members, children);
+
+struct CarTree {
+    Car car;
+    std::vector<CarTree> children;
+};
+register_json_struct(CarTree, car, children);
+
+// test std::string and std::string_view fields
+void test_std_string_fields() {
+    std::cout << "=== Testing std::string and std::string_view Fields ===" << std::endl;
+
+    Profile profile{7, "Jane \"JJ\" Smith", "admin", Car{1, 2.5, "Honda", "Civic"}};
+    std::string json_str = jston::to_json_string(profile);
+    std::cout << "Profile JSON: " << json_str << std::endl;
+
+    // decoding into an existing object reuses the capacity of std::string members
+    Profile loaded{};
+    loaded.name.reserve(64);
+    const char* buffer_before = loaded.name.data();
+    jston::from_json_string(json_str, loaded);
+
+    // string views point into the input text, which outlives them here
+    const char* input_end = json_str.data() + json_str.size();
+    const bool view_into_input =
+        loaded.tag.data() >= json_str.data() && loaded.tag.data() + loaded.tag.size() <= input_end;
+    std::cout << "Decoded Profile: name=" << loaded.name << ", tag=" << loaded.tag << ", car.brand=" << loaded.car.brand
+              << ", capacity reused: " << (loaded.name.data() == buffer_before)
+              << ", tag points into input: " << view_into_input << std::endl;
+
+    // the views have to point into text that outlives the struct, so a temporary string is rejected at compile time
+    // for Profile (and anything nesting it) but accepted for structs without views
+    static_assert(jston::has_string_view_fields<ProfileTree> && !jston::has_string_view_fields<CarTree>,
+                  "std::string_view members are found through containers and recursion");
+    Car temporary_source{};
+    jston::from_json_string(jston::to_json_string(profile.car), temporary_source);
+    Car literal_source{};
+    jston::from_json_string(R"({"id": 3, "brand": "Kia"})", literal_source);
+
+    // a DOM decode points the views into the DOM
+    nlohmann::json dom = jston::to_json(profile);
+    Profile from_dom{};
+    jston::from_json(dom, from_dom);
+
+    bool passed = loaded.id == 7 && loaded.name == profile.name && loaded.tag == "admin" && view_into_input &&
+                  loaded.name.data() == buffer_before && strcmp(loaded.car.model, "Civic") == 0 &&
+                  from_dom.name == profile.name && from_dom.tag == "admin" && temporary_source.price == 2.5 &&
+                  literal_source.id == 3 && strcmp(literal_source.brand, "Kia") == 0;
+    std::cout << (passed ? "std::string field verification passed!" : "Warning: std::string field mismatch!")
+              << std::endl;
+
+    // an escaped string has no zero-copy representation, the view is left untouched and the error reported
+    Profile escaped{};
+    escaped.tag = "unchanged";
+    const std::string escaped_json = R"({"id": 8, "tag": "tab\there"})";
+    jston::from_json_string(escaped_json, escaped);
+    std::cout << "Escaped tag kept as: " << escaped.tag << ", id=" << escaped.id << std::endl;
+}
+
+// struct with variable length std::vector members
+struct Garage {
+    int id;
+    std::vector<int> slots;
+    std::vector<bool> occupied;
+    std::vector<Car> cars;
+};
+register_json_struct(Garage, id, slots, occupied, cars);
+
+// test std::vector fields
+void test_vector_fields() {
+    std::cout << "=== Testing std::vector Fields ===" << std::endl;
+
+    Garage garage{1, {10, 20, 30}, {true, false, true}, {Car{1, 1.5, "Honda", "Civic"}, Car{2, 2.5, "Ford", "Focus"}}};
+    std::string json_str = jston::to_json_string(garage);
+    std::cout << "Garage JSON: " << json_str << std::endl;
+
+    // decoding into an existing object reuses the vector capacity and drops surplus elements
+    Garage loaded{};
+    loaded.slots.reserve(16);
+    loaded.cars.assign(4, Car{});
+    const int* slots_before = loaded.slots.data();
+    const Car* cars_before = loaded.cars.data();
+    jston::from_json_string(json_str, loaded);
+    std::cout << "Decoded Garage: slots=" << loaded.slots.size() << ", occupied=" << loaded.occupied.size()
+              << ", cars=" << loaded.cars.size() << ", capacity reused: "
+              << (loaded.slots.data() == slots_before && loaded.cars.data() == cars_before) << std::endl;
+
+    // the text decoder behaves the same way and honours masks inside vector elements
+    Garage partial{};
+    partial.cars.reserve(8);
+    const Car* partial_before = partial.cars.data();
+    jston::from_json_string(json_str, partial, jston::make_field_mask<Garage>({"cars.brand"}));
+
+    bool passed = loaded.slots == garage.slots && loaded.occupied == garage.occupied && loaded.cars.size() == 2 &&
+                  strcmp(loaded.cars[1].model, "Focus") == 0 && loaded.slots.data() == slots_before &&
+                  loaded.cars.data() == cars_before && partial.cars.size() == 2 &&
+                  partial.cars.data() == partial_before && strcmp(partial.cars[1].brand, "Ford") == 0 &&
+                  partial.cars[1].model[0] == '\0' && partial.slots.empty() &&
+                  jston::to_json(garage) == jston::to_json(*jston::metadata_of<Garage>(), &garage);
+    std::cout << (passed ? "std::vector field verification passed!" : "Warning: std::vector field mismatch!")
+              << std::endl;
+}
+
+// struct with fixed arrays whose live length is held by a sibling count field
+struct Fleet {
+    int id;
+    Car cars[4];
+    short car_count;
+    int readings[6];
+    unsigned int reading_count;
+};
+register_json_struct(Fleet, id, (cars, car_count), car_count, (readings, reading_count), reading_count);
+
+// test fixed arrays bound to a count field
+void test_counted_arrays() {
+    std::cout << "=== Testing Fixed Arrays with Count Field ===" << std::endl;
+
+    Fleet fleet;
+    memset(&fleet, 0, sizeof(fleet));
+    fleet.id = 9;
+    fleet.cars[0] = Car{1, 1.5, "Honda", "Civic"};
+    fleet.cars[1] = Car{2, 2.5, "Ford", "Focus"};
+    fleet.car_count = 2;
+    fleet.readings[0] = 7;
+    fleet.reading_count = 1;
+    std::string json_str = jston::to_json_string(fleet);
+    std::cout << "Fleet JSON: " << json_str << std::endl;
+
+    // both decoders store the number of decoded elements back into the count field
+    Fleet loaded;
+    memset(&loaded, 0, sizeof(loaded));
+    loaded.car_count = 4;
+    jston::from_json(nlohmann::json::parse(json_str), loaded);
+    Fleet scanned;
+    memset(&scanned, 0, sizeof(scanned));
+    jston::from_json_string(json_str, scanned, jston::make_field_mask<Fleet>({"cars", "readings"}));
+    std::cout << "Decoded Fleet: car_count=" << loaded.car_count << ", reading_count=" << loaded.reading_count
+              << ", scanned car_count=" << scanned.car_count << std::endl;
+
+    // an out of range count is clamped to the array capacity, and extra JSON elements are dropped
+    Fleet clamped;
+    memset(&clamped, 0, sizeof(clamped));
+    clamped.car_count = -3;
+    clamped.reading_count = 100;
+    const nlohmann::json clamped_json = jston::to_json(clamped);
+    Fleet overflow;
+    memset(&overflow, 0, sizeof(overflow));
+    jston::from_json(nlohmann::json::parse(R"({"readings": [1, 2, 3, 4, 5, 6, 7, 8]})"), overflow);
+    jston::from_json_string(R"({"cars": [{"id": 1}, {"id": 2}, {"id": 3}, {"id": 4}, {"id": 5}]})", overflow);
+
+    bool passed = jston::to_json(fleet)["cars"].size() == 2 && jston::to_json(fleet)["readings"].size() == 1 &&
+                  jston::to_json(fleet) == jston::to_json(*jston::metadata_of<Fleet>(), &fleet) &&
+                  loaded.car_count == 2 && loaded.reading_count == 1 && strcmp(loaded.cars[1].model, "Focus") == 0 &&
+                  scanned.car_count == 2 && scanned.reading_count == 1 && scanned.readings[0] == 7 &&
+                  clamped_json["cars"].empty() && clamped_json["readings"].size() == 6 &&
+                  overflow.reading_count == 6 && overflow.readings[5] == 6 && overflow.car_count == 4 &&
+                  overflow.cars[3].id == 4;
+    std::cout << (passed ? "Count field verification passed!" : "Warning: count field mismatch!") << std::endl;
+}
+
+// sparse struct with std::optional members
+struct Telemetry {
+    int id;
+    std::optional<int> speed;
+    std::optional<double> temperature;
+    std::optional<std::string> label;
+    std::optional<bool> active;
+    std::optional<Car> car;
+};
+register_json_struct(Telemetry, id, speed, temperature, label, active, car);
+
+// test std::optional fields
+void test_optional_fields() {
+    std::cout << "=== Testing std::optional Fields ===" << std::endl;
+
+    // absent optionals are not emitted at all
+    Telemetry sparse{};
+    sparse.id = 3;
+    sparse.speed = 88;
+    std::string sparse_json = jston::to_json_string(sparse);
+    std::cout << "Sparse Telemetry JSON: " << sparse_json << std::endl;
+
+    Telemetry full{4, 120, 21.5, std::string("probe"), true, Car{1, 1.5, "Honda", "Civic"}};
+    std::string full_json = jston::to_json_string(full);
+    std::cout << "Full Telemetry JSON: " << full_json << std::endl;
+
+    // decoding engages the optionals present in the JSON, null clears them and absent keys leave them untouched
+    Telemetry loaded{};
+    jston::from_json(nlohmann::json::parse(full_json), loaded);
+    jston::from_json(nlohmann::json::parse(R"({"label": null, "active": "yes"})"), loaded);
+    Telemetry scanned{};
+    scanned.temperature = 1.0;
+    jston::from_json_string(sparse_json, scanned);
+    jston::from_json_string(R"({"temperature": null, "car": {"brand": "Ford"}})", scanned,
+                            jston::make_field_mask<Telemetry>({"temperature", "car.brand"}));
+    std::cout << "Decoded Telemetry: speed=" << loaded.speed.value_or(-1) << ", label="
+              << loaded.label.value_or("<absent>")
+              << ", scanned car=" << (scanned.car ? scanned.car->brand : "<absent>") << std::endl;
+
+    bool passed = jston::to_json(sparse).size() == 2 && jston::to_json(full).size() == 6 &&
+                  jston::to_json(full) == jston::to_json(*jston::metadata_of<Telemetry>(), &full) &&
+                  jston::to_json(sparse) == jston::to_json(*jston::metadata_of<Telemetry>(), &sparse) &&
+                  loaded.speed == 120 && loaded.temperature == 21.5 && !loaded.label && loaded.active == true &&
+                  loaded.car && strcmp(loaded.car->model, "Civic") == 0 && scanned.id == 3 && scanned.speed == 88 &&
+                  !scanned.temperature && !scanned.label && scanned.car && strcmp(scanned.car->brand, "Ford") == 0 &&
+                  scanned.car->model[0] == '\0';
+    std::cout << (passed ? "std::optional field verification passed!" : "Warning: std::optional field mismatch!")
+              << std::endl;
+}
+
+// enums emitted by name, by integer, and left unregistered
+enum class Side { BUY, SELL };
+enum OrderType { LIMIT = 1, MARKET = 2, STOP = 4 };
+enum class Venue : unsigned char { XNYS, XNAS };
+register_json_enum(Side, BUY, SELL);
+register_json_enum_as_int(OrderType, LIMIT, MARKET, STOP);
+
+struct Order {
+    int id;
+    Side side;
+    OrderType type;
+    Venue venue;
+};
+register_json_struct(Order, id, side, type, venue);
+
+// the enumerator name index is a compile-time perfect hash
+static_assert(jston::enum_ops_of<Side>::index.find(jston::enum_info<Side>::entries, "SELL") == 1,
+              "enumerator names should be found at compile time");
+static_assert(jston::enum_ops_of<OrderType>::index.find(jston::enum_info<OrderType>::entries, "LIMITS") == -1,
+              "unknown enumerator names should not be found");
+
+// test enum fields
+void test_enum_fields() {
+    std::cout << "=== Testing Enum Fields ===" << std::endl;
+
+    Order order{7, Side::SELL, STOP, Venue::XNAS};
+    std::string json_str = jston::to_json_string(order);
+    std::cout << "Order JSON: " << json_str << std::endl;
+
+    // both decoders accept enumerator names and integers in either mode
+    Order loaded{};
+    jston::from_json(nlohmann::json::parse(R"({"id": 7, "side": "SELL", "type": "STOP", "venue": 1})"), loaded);
+    Order scanned{};
+    jston::from_json_string(R"({"id": 8, "side": 1, "type": "MARKET", "venue": 1})", scanned);
+    std::cout << "Decoded Orders: side=" << static_cast<int>(loaded.side) << ", type=" << loaded.type
+              << ", scanned type=" << scanned.type << std::endl;
+
+    // an unknown name is reported and leaves the field untouched
+    Order unknown{1, Side::BUY, LIMIT, Venue::XNYS};
+    jston::from_json_string(R"({"side": "HOLD"})", unknown);
+
+    // so is an integer that the underlying type of the enum cannot hold
+    Order wide{2, Side::BUY, LIMIT, Venue::XNAS};
+    jston::from_json_string(R"({"venue": 256, "type": 1e30})", wide);
+
+    bool passed = json_str == R"({"id":7,"side":"SELL","type":4,"venue":1})" &&
+                  jston::to_json(order) == jston::to_json(*jston::metadata_of<Order>(), &order) &&
+                  loaded.side == Side::SELL && loaded.type == STOP && loaded.venue == Venue::XNAS &&
+                  scanned.side == Side::SELL && scanned.type == MARKET && unknown.side == Side::BUY &&
+                  wide.venue == Venue::XNAS && wide.type == LIMIT;
+    std::cout << (passed ? "Enum field verification passed!" : "Warning: enum field mismatch!") << std::endl;
+}
+
+// struct with associative containers keyed by std::string
+struct SymbolStats {
+    int trades;
+    double volume;
+};
+register_json_struct(SymbolStats, trades, volume);
+
+struct Book {
+    int id;
+    std::unordered_map<std::string, SymbolStats> stats;
+    std::map<std::string, int> limits;
+    std::vector<std::pair<std::string, double>> prices;
+    std::unordered_map<std::string, std::string> tags;
+};
+register_json_struct(Book, id, stats, limits, prices, tags);
+
+// test std::map, std::unordered_map and flat map fields
+void test_map_fields() {
+    std::cout << "=== Testing Map Fields ===" << std::endl;
+
+    Book book{1,
+              {{"AAPL", {10, 1500.5}}, {"MSFT", {4, 820.25}}},
+              {{"AAPL", 100}, {"MSFT", 50}},
+              {{"AAPL", 189.5}, {"MSFT", 410.0}},
+              {{"desk", "equities"}}};
+    std::string json_str = jston::to_json_string(book);
+    std::cout << "Book JSON: " << json_str << std::endl;
+
+    // decoding replaces the previous contents, and flat maps come back sorted by key
+    Book loaded{};
+    loaded.stats["OLD"] = {1, 1.0};
+    jston::from_json(nlohmann::json::parse(json_str), loaded);
+    Book scanned{};
+    scanned.limits["OLD"] = 1;
+    jston::from_json_string(R"({"prices": {"MSFT": 410.0, "AAPL": 189.5, "IBM": 1}, "limits": {"IBM": 5},
+                               "stats": {"IBM": {"trades": 2, "volume": 3.5}}})",
+                            scanned, jston::make_field_mask<Book>({"prices", "limits", "stats.trades"}));
+    std::cout << "Decoded Book: stats=" << loaded.stats.size() << ", scanned prices=" << scanned.prices.size()
+              << ", first=" << (scanned.prices.empty() ? "" : scanned.prices.front().first) << std::endl;
+
+    bool passed = loaded.stats.size() == 2 && loaded.stats.count("OLD") == 0 && loaded.stats["MSFT"].trades == 4 &&
+                  loaded.limits == book.limits && loaded.prices == book.prices && loaded.tags == book.tags &&
+                  jston::to_json(book) == jston::to_json(*jston::metadata_of<Book>(), &book) &&
+                  scanned.prices.size() == 3 && scanned.prices[0].first == "AAPL" && scanned.prices[1].first == "IBM" &&
+                  scanned.limits.size() == 1 && scanned.limits["IBM"] == 5 && scanned.stats["IBM"].trades == 2 &&
+                  scanned.stats["IBM"].volume == 0;
+    std::cout << (passed ? "Map field verification passed!" : "Warning: map field mismatch!") << std::endl;
+}
+
+// struct with multi-dimensional arrays
+struct Tile {
+    int id;
+    double matrix[3][4];
+    unsigned short pixels[2][2][3];
+    Point corners[2][2];
+};
+register_json_struct(Tile, id, matrix, pixels, corners);
+
+// test multi-dimensional array fields
+void test_multi_dimensional_arrays() {
+    std::cout << "=== Testing Multi-Dimensional Arrays ===" << std::endl;
+
+    Tile tile;
+    memset(&tile, 0, sizeof(tile));
+    tile.id = 5;
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            tile.matrix[r][c] = r * 10 + c + 0.5;
+        }
+    }
+    tile.pixels[1][0][2] = 255;
+    tile.corners[1][1] = Point{3, 4};
+    std::string json_str = jston::to_json_string(tile);
+    std::cout << "Tile JSON: " << json_str << std::endl;
+
+    Tile loaded;
+    memset(&loaded, 0, sizeof(loaded));
+    jston::from_json(nlohmann::json::parse(json_str), loaded);
+    Tile scanned;
+    memset(&scanned, 0, sizeof(scanned));
+    jston::from_json_string(json_str, scanned);
+
+    // short rows are filled from the front, extra rows and elements are ignored
+    Tile ragged;
+    memset(&ragged, 0, sizeof(ragged));
+    jston::from_json_string(R"({"matrix": [[1, 2], [3, 4, 5, 6, 7], [8], [9, 9]]})", ragged);
+
+    const nlohmann::json j = jston::to_json(tile);
+    bool passed = j["matrix"].size() == 3 && j["matrix"][2].size() == 4 && j["matrix"][2][3] == 23.5 &&
+                  j["pixels"][1][0][2] == 255 && j["corners"][1][1]["y"] == 4 &&
+                  j == jston::to_json(*jston::metadata_of<Tile>(), &tile) &&
+                  memcmp(&loaded, &tile, sizeof(tile)) == 0 && memcmp(&scanned, &tile, sizeof(tile)) == 0 &&
+                  ragged.matrix[0][1] == 2 && ragged.matrix[0][2] == 0 && ragged.matrix[1][3] == 6 &&
+                  ragged.matrix[2][0] == 8;
+    std::cout << (passed ? "Multi-dimensional array verification passed!"
+                         : "Warning: multi-dimensional array mismatch!")
+              << std::endl;
+}
+
+// struct with byte blobs and every integer array element type
+struct Packet {
+    uint8_t digest[8];
+    uint8_t payload[32];
+    unsigned char payload_len;
+    int8_t deltas[3];
+    unsigned long offsets[2];
+    unsigned long long stamps[2];
+};
+register_json_struct(Packet, (digest, hex), (payload, payload_len, base64), deltas, offsets, stamps);
+
+// test integer arrays of all widths and base64 / hex encoded byte arrays
+void test_byte_arrays() {
+    std::cout << "=== Testing Byte Arrays ===" << std::endl;
+
+    Packet packet;
+    memset(&packet, 0, sizeof(packet));
+    for (int i = 0; i < 8; ++i) {
+        packet.digest[i] = static_cast<uint8_t>(0x10 * i + 0x0F);
+    }
+    const char text[] = "jston packs bytes!";
+    packet.payload_len = sizeof(text) - 1;
+    memcpy(packet.payload, text, packet.payload_len);
+    packet.deltas[0] = -128;
+    packet.deltas[2] = 127;
+    packet.offsets[1] = 4000000000UL;
+    packet.stamps[0] = 18446744073709551615ULL;
+    std::string json_str = jston::to_json_string(packet);
+    std::cout << "Packet JSON: " << json_str << std::endl;
+
+    Packet loaded;
+    memset(&loaded, 0, sizeof(loaded));
+    jston::from_json(nlohmann::json::parse(json_str), loaded);
+    Packet scanned;
+    memset(&scanned, 0, sizeof(scanned));
+    jston::from_json_string(json_str, scanned);
+
+    // unpadded base64 is accepted, bytes beyond the capacity are dropped and malformed text is reported
+    Packet edge;
+    memset(&edge, 0, sizeof(edge));
+    jston::from_json_string(R"({"payload": "AQID", "digest": "00112233445566778899"})", edge);
+    Packet unpadded;
+    memset(&unpadded, 0, sizeof(unpadded));
+    jston::from_json_string(R"({"payload": "aGk", "digest": "zz"})", unpadded);
+
+    const nlohmann::json j = jston::to_json(packet);
+    bool passed = j["digest"] == "0f1f2f3f4f5f6f7f" && j["payload"] == "anN0b24gcGFja3MgYnl0ZXMh" &&
+                  j["deltas"][0] == -128 && j["offsets"][1] == 4000000000UL &&
+                  j["stamps"][0] == 18446744073709551615ULL &&
+                  j == jston::to_json(*jston::metadata_of<Packet>(), &packet) &&
+                  memcmp(&loaded, &packet, sizeof(packet)) == 0 && memcmp(&scanned, &packet, sizeof(packet)) == 0 &&
+                  edge.payload_len == 3 && edge.payload[2] == 3 && edge.digest[7] == 0x77 &&
+                  unpadded.payload_len == 2 && unpadded.payload[1] == 'i' && unpadded.digest[0] == 0;
+    std::cout << (passed ? "Byte array verification passed!" : "Warning: byte array mismatch!") << std::endl;
+}
+
+// test that keys are written in registration order and read back in any order
+void test_key_order() {
+    std::cout << "=== Testing Registration Order Keys ===" << std::endl;
+
+    Profile profile{11, "tab\there \"quoted\"\x01", "ops", Car{2, 1e21, "Mazda", "MX-5"}};
+    std::string json_str = jston::to_json_string(profile);
+    std::cout << "Profile JSON: " << json_str << std::endl;
+
+    // the same document in registration order, in reverse, and shuffled with whitespace and an unknown key
+    const std::string in_order = R"({"id":5,"name":"a","car":{"id":1,"price":2.5,"brand":"Kia","model":"Rio"}})";
+    const std::string reversed = R"({"car":{"model":"Rio","brand":"Kia","price":2.5,"id":1},"name":"a","id":5})";
+    const std::string shuffled =
+        R"({ "name" : "a", "extra": [1, {"id": 9}], "car": {"price": 2.5, "id": 1, "model": "Rio", "brand": "Kia"},
+             "id": 5 })";
+    bool same = true;
+    for (int round = 0; round < 3; ++round) {
+        for (const std::string* text : {&in_order, &reversed, &shuffled, &in_order}) {
+            Profile loaded{};
+            jston::from_json_string(*text, loaded);
+            same = same && loaded.id == 5 && loaded.name == "a" && loaded.car.id == 1 && loaded.car.price == 2.5 &&
+                   strcmp(loaded.car.brand, "Kia") == 0 && strcmp(loaded.car.model, "Rio") == 0;
+        }
+    }
+
+    Profile scanned{};
+    jston::from_json_string(json_str, scanned);
+    bool passed = json_str.find(R"({"id":11,"name":)") == 0 &&
+                  json_str.find(R"("tag":"ops","car":{"id":2,)") != std::string::npos &&
+                  nlohmann::json::parse(json_str) == jston::to_json(profile) && scanned.name == profile.name &&
+                  scanned.car.price == 1e21 && same;
+    std::cout << (passed ? "Key order verification passed!" : "Warning: key order mismatch!") << std::endl;
+}
+
+// struct whose JSON text has a bounded length
+struct Beacon {
+    int id;
+    long long stamp;
+    unsigned short port;
+    int8_t rssi;
+    float gain;
+    double lat;
+    bool armed;
+    char callsign[4];
+    short grid[2][2];
+    uint8_t key[5];
+    Point origin;
+    Side side;
+};
+register_json_struct(Beacon, id, stamp, port, rssi, gain, lat, armed, callsign, grid, (key, hex), origin, side);
+
+// bounded structs that nothing but the first call check in test_max_json_size converts
+struct Cell {
+    short row;
+    short col;
+};
+register_json_struct(Cell, row, col);
+
+struct Board {
+    int id;
+    Cell corners[2];
+    Cell center;
+    std::optional<Cell> mark;
+};
+register_json_struct(Board, id, corners, center, mark);
+
+// heap allocations of the whole program, counted by the replaced global allocation functions
+// every form of new and delete goes through counted_malloc and counted_free, kept out of line so that GCC does not
+// see them inlined next to an operator new (-Wmismatched-new-delete, -Walloc-size-larger-than)
+static size_t heap_allocations = 0;
+
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+static void* counted_malloc(std::size_t size) noexcept {
+    ++heap_allocations;
+    return std::malloc(size ? size : 1);
+}
+
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+static void counted_free(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void* operator new(std::size_t size) {
+    if (void* ptr = counted_malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return counted_malloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return counted_malloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    counted_free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    counted_free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    counted_free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    counted_free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    counted_free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    counted_free(ptr);
+}
+
+// test worst-case size computation and serialization into a stack buffer
+void test_max_json_size() {
+    std::cout << "=== Testing Max JSON Size ===" << std::endl;
+
+    static_assert(jston::max_json_size<Point> == 2 + 2 * 11 + 1 + 2 * 4, "two ints and their quoted keys");
+    static_assert(jston::max_json_size<Profile> == 0, "std::string fields have no bound");
+
+    // every field at its longest text
+    Beacon beacon{std::numeric_limits<int>::min(), std::numeric_limits<long long>::min(), 65535, -128,
+                  -1000000061440.0f, -1018823507392274104320.0, false, {'\x01', '\x02', '\x03', '\x04'},
+                  {{-32768, -32768}, {-32768, -32768}}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+                  Point{std::numeric_limits<int>::min(), std::numeric_limits<int>::min()},
+                  static_cast<Side>(std::numeric_limits<std::underlying_type_t<Side>>::min())};
+    char buffer[jston::max_json_size<Beacon> + 1];
+    const size_t length = jston::serialize_to(buffer, beacon);
+    const std::string json_str = jston::to_json_string(beacon);
+    std::cout << "Beacon JSON (" << length << " of at most " << jston::max_json_size<Beacon> << "): " << buffer
+              << std::endl;
+
+    bool too_small = false;
+    char small[16];
+    try {
+        jston::serialize_to(small, sizeof(small), beacon);
+    } catch (const std::exception&) {
+        too_small = true;
+    }
+    Beacon loaded{};
+    jston::from_json_string(std::string(buffer, length), loaded);
+
+    // the first call for a type does not allocate either, nested structs included
+    Board board{3, {Cell{1, 2}, Cell{3, 4}}, Cell{5, 6}, Cell{7, 8}};
+    char board_buffer[jston::max_json_size<Board> + 1];
+    const size_t allocations_before = heap_allocations;
+    jston::serialize_to(board_buffer, board);
+    const size_t first_call_allocations = heap_allocations - allocations_before;
+    std::cout << "First Board serialization: " << board_buffer << ", allocations=" << first_call_allocations
+              << std::endl;
+
+    bool passed = length == jston::max_json_size<Beacon> && json_str == std::string(buffer, length) &&
+                  buffer[length] == '\0' && too_small && loaded.lat == beacon.lat && loaded.gain == beacon.gain &&
+                  loaded.key[4] == 0xFF && loaded.side == beacon.side && first_call_allocations == 0 &&
+                  jston::to_json_string(board) == board_buffer;
+    std::cout << (passed ? "Max JSON size verification passed!" : "Warning: max JSON size mismatch!") << std::endl;
+}
+
+// test lazy partial decode of selected fields from JSON text
+void test_partial_decode() {
+    std::cout << "=== Testing Partial Decode with Field Mask ===" << std::endl;
+
+    // fields that are not requested are skipped without decoding, including escaped strings and nested arrays
+    std::string json_str = R"({
+        "phone_numbers": [1, 2, 3, 4, 5],
+        "name": "Jane \"JJ\" Smith",
+        "car": {"model": "Accord", "price": 45000.75, "brand": "Honda", "id": 1002},
+        "age": 25,
+        "ignored": {"nested": [{"deep": "]}"}, "x"]}
+    })";
+
+    try {
+        Person person;
+        memset(&person, 0, sizeof(person));
+        jston::field_mask mask = jston::make_field_mask<Person>({"age", "car.brand"});
+        jston::from_json_string(json_str, person, mask);
+        std::cout << "Partially decoded Person: age=" << person.age << ", car.brand=" << person.car.brand
+                  << ", car.model='" << person.car.model << "', name='" << person.name << "'" << std::endl;
+
+        bool passed = person.age == 25 && strcmp(person.car.brand, "Honda") == 0 && person.car.model[0] == '\0' &&
+                      person.name[0] == '\0' && person.phone_numbers[0] == 0;
+        std::cout << (passed ? "Partial decode verification passed!" : "Warning: partial decode mismatch!")
+                  << std::endl;
+
+        // decoding stops once all requested fields are filled, so trailing content is never scanned
+        Person early;
+        memset(&early, 0, sizeof(early));
+        jston::from_json_string(R"({"age": 41, "name": "Early Stop", "rest": [ this is never scanned)", early,
+                                jston::make_field_mask<Person>({"age", "name"}));
+        std::cout << "Early stop decode: age=" << early.age << ", name=" << early.name << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Partial decode test failed: " << e.what() << std::endl;
+    }
+
+    // malformed content inside the scanned region is still reported
+    try {
+        Person person;
+        jston::from_json_string(R"({"car": {"brand": "Honda"}, "age" 1})", person,
+                                jston::make_field_mask<Person>({"age"}));
+        std::cout << "This line should not be executed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cout << "Successfully caught malformed input: " << e.what() << std::endl;
+    }
+}
+
+// struct with floating point fields parsed directly from text
+struct Gauge {
+    float level;
+    double reading;
+    float samples[4];
+};
+register_json_struct(Gauge, level, reading, samples);
+
+// test exact float and double parsing in from_json_string
+void test_floating_parse() {
+    std::cout << "=== Testing Exact Floating Point Parsing ===" << std::endl;
+
+    // just above the midpoint between 1 and the next float, rounding through double would land on 1.0f
+    std::string json_str = R"({"level": 1.000000059604644775390625000001, "reading": 0.1,
+        "samples": [3.4028235e38, 1e-45, -0.0, 7.0e-3]})";
+    Gauge gauge{};
+    jston::from_json_string(json_str, gauge);
+    std::cout << "Parsed gauge: level=" << gauge.level << ", reading=" << gauge.reading
+              << ", samples[0]=" << gauge.samples[0] << ", samples[1]=" << gauge.samples[1] << std::endl;
+
+    bool passed = gauge.level == 1.00000011920928955078125f && gauge.reading == 0.1 &&
+                  gauge.samples[0] == std::numeric_limits<float>::max() &&
+                  gauge.samples[1] == std::numeric_limits<float>::denorm_min() && gauge.samples[2] == 0.0f &&
+                  std::signbit(gauge.samples[2]) && gauge.samples[3] == 7.0e-3f;
+
+    // values too small for the type underflow to zero of the same sign, only an overflow is reported
+    Gauge tiny{};
+    tiny.samples[2] = 1.0f;
+    jston::from_json_string(R"({"level": -1e-50, "reading": 1e-400, "samples": [0.00001e-320, 2e-46, 1e39]})", tiny);
+    std::cout << "Parsed underflow: level=" << tiny.level << ", reading=" << tiny.reading << std::endl;
+    passed = passed && tiny.level == 0.0f && std::signbit(tiny.level) && tiny.reading == 0.0 &&
+             !std::signbit(tiny.reading) && tiny.samples[0] == 0.0f && tiny.samples[1] == 0.0f;
+    Gauge huge{};
+    jston::from_json_string(R"({"reading": -1e400})", huge);
+    passed = passed && huge.reading == 0.0;
+
+    // random bit patterns round trip through the shortest representation and through 17 significant digits
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    int mismatches = 0;
+    for (int i = 0; i < 20000; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        double expected_reading;
+        float expected_level;
+        uint32_t level_bits = static_cast<uint32_t>(state >> 32);
+        memcpy(&expected_reading, &state, sizeof(expected_reading));
+        memcpy(&expected_level, &level_bits, sizeof(expected_level));
+        if (!std::isfinite(expected_reading) || !std::isfinite(expected_level)) {
+            continue;
+        }
+        char reading[64];
+        char level[64];
+        *std::to_chars(reading, reading + sizeof(reading), expected_reading, std::chars_format::general, 17).ptr =
+            '\0';
+        *std::to_chars(level, level + sizeof(level), expected_level).ptr = '\0';
+        Gauge parsed{};
+        jston::from_json_string(std::string("{\"level\": ") + level + ", \"reading\": " + reading + "}", parsed);
+        mismatches += memcmp(&parsed.level, &expected_level, sizeof(float)) != 0 ||
+                      memcmp(&parsed.reading, &expected_reading, sizeof(double)) != 0;
+    }
+    std::cout << "Random round trip mismatches: " << mismatches << std::endl;
+    passed = passed && mismatches == 0;
+    std::cout << (passed ? "Floating point parse verification passed!" : "Warning: floating point parse mismatch!")
+              << std::endl;
+}
+
+// struct with integer fields of several widths
+struct Counter {
+    short small;
+    unsigned int count;
+    long long stamp;
+    int values[4];
+    unsigned long long total;
+};
+register_json_struct(Counter, small, count, stamp, values, total);
+
+// test range checked integer parsing in from_json_string
+void test_integer_parse() {
+    std::cout << "=== Testing Integer Parsing ===" << std::endl;
+
+    // elements that do not fit an int are skipped, leaving the previous value in place
+    std::string json_str = R"({"small": -32768, "count": 4294967295, "stamp": 1700000000123456789,
+        "values": [1, 2147483648, -2147483648, 12345678901234567], "total": 18446744073709551615})";
+    Counter counter{};
+    counter.values[1] = counter.values[3] = 99;
+    jston::from_json_string(json_str, counter);
+    std::cout << "Parsed counter: small=" << counter.small << ", count=" << counter.count << ", stamp=" << counter.stamp
+              << ", values=[" << counter.values[0] << ", " << counter.values[1] << ", " << counter.values[2] << ", "
+              << counter.values[3] << "], total=" << counter.total << std::endl;
+
+    bool passed = counter.small == -32768 && counter.count == 4294967295U && counter.stamp == 1700000000123456789LL &&
+                  counter.values[0] == 1 && counter.values[1] == 99 &&
+                  counter.values[2] == std::numeric_limits<int>::min() && counter.values[3] == 99 &&
+                  counter.total == std::numeric_limits<unsigned long long>::max();
+
+    // a scalar outside the field width is reported and the field keeps its value
+    Counter overflow{};
+    overflow.small = 7;
+    jston::from_json_string(R"({"small": 32768, "count": -1, "total": 18446744073709551616, "stamp": 12})", overflow);
+    std::cout << "Out of range input: small=" << overflow.small << ", count=" << overflow.count
+              << ", total=" << overflow.total << ", stamp=" << overflow.stamp << std::endl;
+    passed = passed && overflow.small == 7 && overflow.count == 0 && overflow.total == 0 && overflow.stamp == 12;
+
+    // a fraction or an exponent is only accepted for an integral value that fits the field
+    Counter scaled{};
+    scaled.small = 7;
+    jston::from_json_string(R"({"small": 1e10, "count": -1.5, "stamp": 1e30, "total": 2.5e3})", scaled);
+    std::cout << "Fraction and exponent input: small=" << scaled.small << ", count=" << scaled.count
+              << ", stamp=" << scaled.stamp << ", total=" << scaled.total << std::endl;
+    passed = passed && scaled.small == 7 && scaled.count == 0 && scaled.stamp == 0 && scaled.total == 2500;
+    std::cout << (passed ? "Integer parse verification passed!" : "Warning: integer parse mismatch!") << std::endl;
+}
+
+// test skipping large unselected values whose strings contain brackets and escapes
+void test_bulk_skip() {
+    std::cout << "=== Testing Bulk Skip of Unselected Values ===" << std::endl;
+
+    // the skipped value spans many 64-byte blocks, with escaped quotes and backslash runs across block boundaries
+    std::string ignored = "[";
+    for (int i = 0; i < 200; ++i) {
+        ignored += i ? ", " : "";
+        ignored += R"({"text": "]}\\\"[{ )" + std::string(static_cast<size_t>(i % 61), 'x') + R"(\\\\", "n": [[)" +
+                   std::to_string(i) + "], {}]}";
+    }
+    ignored += "]";
+    std::string json_str = R"({"ignored": )" + ignored + R"(, "name": "After \"skip\"", "age": 52})";
+
+    Person person;
+    memset(&person, 0, sizeof(person));
+    jston::from_json_string(std::string_view(json_str), person, jston::make_field_mask<Person>({"age", "name"}));
+    Person full;
+    memset(&full, 0, sizeof(full));
+    jston::from_json_string(json_str, full);
+    std::cout << "Skipped " << ignored.size() << " bytes: age=" << person.age << ", name=" << person.name << std::endl;
+
+    bool passed = person.age == 52 && strcmp(person.name, "After \"skip\"") == 0 && full.age == 52 &&
+                  strcmp(full.name, person.name) == 0;
+
+    // a string left open inside a skipped value is still reported
+    try {
+        jston::from_json_string(R"({"ignored": )" + ignored.substr(0, ignored.size() - 1) + R"(, "open]})", full);
+        passed = false;
+    } catch (const std::exception& e) {
+        std::cout << "Successfully caught unterminated value: " << e.what() << std::endl;
+    }
+
+    // a full decode checks the syntax of the members it skips, a masked decode only matches brackets and quotes
+    const std::string malformed[] = {R"({"age": 1, "zzz": tru})", R"({"age": 1, "x": @@@})",
+                                     R"({"x": "\q", "age": 1})", "{\"x\": \"a\tb\", \"age\": 1}",
+                                     R"({"age": "1\q"})"};
+    for (const std::string& text : malformed) {
+        try {
+            jston::from_json_string(text, full);
+            passed = false;
+        } catch (const std::exception& e) {
+            std::cout << "Successfully caught malformed skipped value: " << e.what() << std::endl;
+        }
+        Person masked;
+        memset(&masked, 0, sizeof(masked));
+        jston::from_json_string(text, masked, jston::make_field_mask<Person>({"age", "car"}));
+        passed = passed && (masked.age == 1 || text.find("\"1") != std::string::npos);
+    }
+    std::cout << (passed ? "Bulk skip verification passed!" : "Warning: bulk skip mismatch!") << std::endl;
+}
+
+// test the on-demand cursor mixing custom reads with struct decoding
+void test_cursor() {
+    std::cout << "=== Testing On-Demand Cursor ===" << std::endl;
+
+    const std::string json_str = R"({"version": 2, "kind": "car", "payload": {"id": 7, "brand": "Honda",
+        "model": "Civic", "price": 21000.5, "unknown": [1]}, "tags": ["fast", "a \"b\""], "extra": {"x": [1, 2]},
+        "ignored": [{"deep": "]}"}], "ratio": 0.25, "enabled": true, "parent": null})";
+
+    long long version = 0;
+    std::string kind;
+    Car car{};
+    std::vector<std::string> tags;
+    std::string_view extra;
+    double ratio = 0;
+    bool enabled = false;
+    bool parent_is_null = false;
+    try {
+        jston::json_cursor cursor(json_str);
+        cursor.begin_object();
+        std::string_view key;
+        while (cursor.next_member(key)) {
+            if (key == "version") {
+                version = cursor.read_integer();
+            } else if (key == "kind") {
+                kind = std::string(cursor.read_string());
+            } else if (key == "payload" && kind == "car") {
+                cursor.decode_into(car);
+            } else if (key == "tags") {
+                cursor.begin_array();
+                while (cursor.next_element()) {
+                    tags.emplace_back(cursor.read_string());
+                }
+            } else if (key == "extra") {
+                extra = cursor.raw();
+            } else if (key == "ratio") {
+                ratio = cursor.read_double();
+            } else if (key == "enabled") {
+                enabled = cursor.read_bool();
+            } else if (key == "parent") {
+                parent_is_null = cursor.read_null();
+            } else {
+                cursor.skip();
+            }
+        }
+        std::cout << "Cursor read: version=" << version << ", kind=" << kind << ", car.brand=" << car.brand
+                  << ", tags=" << tags.size() << ", extra=" << extra << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Cursor test failed: " << e.what() << std::endl;
+    }
+    bool passed = version == 2 && kind == "car" && car.id == 7 && strcmp(car.model, "Civic") == 0 &&
+                  car.price == 21000.5 && tags.size() == 2 && tags[1] == "a \"b\"" && extra == R"({"x": [1, 2]})" &&
+                  ratio == 0.25 && enabled && parent_is_null;
+
+    // a copy of the cursor is a bookmark: the version is peeked, then the whole message is decoded from the copy
+    const std::string flat = R"({"version": 1, "age": 30, "name": "Ann"})";
+    jston::json_cursor message(flat);
+    const jston::json_cursor start = message;
+    std::string_view key;
+    message.begin_object();
+    if (message.next_member(key) && key == "version" && message.read_integer() == 1) {
+        Person person;
+        memset(&person, 0, sizeof(person));
+        jston::json_cursor(start).decode_into(person);
+        std::cout << "Version 1 message decoded as Person: age=" << person.age << ", name=" << person.name << std::endl;
+        passed = passed && person.age == 30 && strcmp(person.name, "Ann") == 0;
+    } else {
+        passed = false;
+    }
+
+    // reading the wrong type is a syntax error at the cursor position
+    try {
+        jston::json_cursor cursor(R"({"id": "seven"})");
+        cursor.begin_object();
+        cursor.next_member(key);
+        cursor.read_integer();
+        passed = false;
+    } catch (const std::exception& e) {
+        std::cout << "Successfully caught type mismatch: " << e.what() << std::endl;
+    }
+    std::cout << (passed ? "Cursor verification passed!" : "Warning: cursor mismatch!") << std::endl;
+}
+
+// test the incremental decoder with a message that arrives in pieces
+void test_push_decoder() {
+    std::cout << "=== Testing Incremental Decoder ===" << std::endl;
+
+    Garage garage{3, {10, -20, 30}, {true, false}, {Car{1, 1.5, "Honda", "Civic"}, Car{2, 2.5, "Fo\"rd", "Focus"}}};
+    const std::string json_str = jston::to_json_string(garage) + " " + R"({"id": 4, "slots": [5]})";
+    std::cout << "Garage messages: " << json_str << std::endl;
+
+    // every chunk is copied into the same small buffer, so nothing may refer back to an earlier chunk
+    bool passed = true;
+    for (size_t chunk_size : {1, 3, 7, 4096}) {
+        Garage first{};
+        Garage second{};
+        jston::decoder<Garage> decoder(first);
+        char buffer[4096];
+        size_t pos = 0;
+        int messages = 0;
+        while (pos < json_str.size()) {
+            const size_t length = std::min(chunk_size, json_str.size() - pos);
+            memcpy(buffer, json_str.data() + pos, length);
+            // a chunk may end one message and start the next, the rest of it goes to the next message
+            size_t offset = 0;
+            while (offset < length) {
+                const bool done = decoder.feed(buffer + offset, length - offset);
+                offset += decoder.consumed();
+                if (done) {
+                    ++messages;
+                    decoder.reset(second);
+                }
+            }
+            pos += length;
+        }
+        passed = passed && messages == 2 && jston::to_json_string(first) == jston::to_json_string(garage) &&
+                 second.id == 4 && second.slots == std::vector<int>{5} && strcmp(first.cars[1].brand, "Fo\"rd") == 0;
+    }
+    std::cout << "Decoded in 1, 3, 7 and 4096 byte chunks" << std::endl;
+
+    // syntax errors are reported with their offset in the whole message
+    try {
+        Garage broken{};
+        jston::decoder<Garage> decoder(broken);
+        decoder.feed(R"({"id": 1, "slots": [1, )");
+        decoder.feed(R"(2 3]})");
+        passed = false;
+    } catch (const std::exception& e) {
+        std::cout << "Successfully caught error: " << e.what() << std::endl;
+    }
+
+    // skipped members are checked like in from_json_string, also when they span chunks
+    try {
+        Garage broken{};
+        jston::decoder<Garage> decoder(broken);
+        decoder.feed(R"({"id": 1, "note": "a\)");
+        decoder.feed(R"(q", "slots": []})");
+        passed = false;
+    } catch (const std::exception& e) {
+        std::cout << "Successfully caught malformed skipped value: " << e.what() << std::endl;
+    }
+
+    // a std::string_view field would point into a chunk that is gone by the time the message is complete, so
+    // jston::decoder<Profile> does not compile; structs nesting Profile at any depth are rejected too
+    static_assert(jston::has_string_view_fields<Profile> && !jston::has_string_view_fields<Garage>,
+                  "only structs with std::string_view fields are rejected by jston::decoder");
+    std::cout << (passed ? "Incremental decoder verification passed!" : "Warning: incremental decoder mismatch!")
+              << std::endl;
+}
+
+// struct whose map and optional members hold values much larger than a chunk
+struct Depot {
+    std::map<std::string, Garage> garages;
+    std::unordered_map<std::string, int> counts;
+    std::optional<Garage> spare;
+};
+register_json_struct(Depot, garages, counts, spare);
+
+// test the coroutine encoder that hands out the text in chunks
+void test_encode_chunks() {
+    std::cout << "=== Testing Chunked Encoder ===" << std::endl;
+#if defined(JSTON_HAS_COROUTINES)
+    Garage garage{5, {}, {true, false, true}, {}};
+    for (int i = 0; i < 200; ++i) {
+        garage.slots.push_back(i * 37 - 1000);
+        garage.cars.push_back(Car{i, i * 0.5, "Toyota", "Corolla"});
+    }
+    Level1 level1{};
+    level1.id = 1;
+    strcpy(level1.name, "root");
+    level1.items[1].items[0].items[1].items[2].value = 2.5;
+
+    // the chunks add up to the whole text, each but the last reaching the chunk size
+    bool passed = true;
+    size_t chunks = 0;
+    size_t largest = 0;
+    std::string text;
+    for (std::string_view chunk : jston::encode_chunks(garage, 64)) {
+        if (!text.empty()) {
+            passed = passed && text.size() - text.rfind('|') - 1 >= 64;
+        }
+        text += '|';
+        text += chunk;
+        ++chunks;
+        largest = std::max(largest, chunk.size());
+    }
+    text.erase(std::remove(text.begin(), text.end(), '|'), text.end());
+    passed = passed && text == jston::to_json_string(garage) && largest < 128;
+    std::cout << "Garage encoded in " << chunks << " chunks of up to " << largest << " bytes" << std::endl;
+
+    // map entries and the value of an optional are split the same way
+    Depot depot;
+    for (int i = 0; i < 100; ++i) {
+        depot.counts["bay" + std::to_string(i)] = i;
+    }
+    depot.garages["north"] = garage;
+    depot.garages["south"] = garage;
+    depot.spare = garage;
+    text.clear();
+    chunks = 0;
+    largest = 0;
+    for (std::string_view chunk : jston::encode_chunks(depot, 64)) {
+        text += chunk;
+        ++chunks;
+        largest = std::max(largest, chunk.size());
+    }
+    passed = passed && text == jston::to_json_string(depot) && largest < 128;
+    std::cout << "Depot encoded in " << chunks << " chunks of up to " << largest << " bytes" << std::endl;
+
+    // chunks can go straight into the incremental decoder
+    Level1 loaded{};
+    jston::decoder<Level1> decoder(loaded);
+    bool done = false;
+    chunks = 0;
+    for (std::string_view chunk : jston::encode_chunks(level1, 64)) {
+        done = decoder.feed(chunk);
+        ++chunks;
+    }
+    passed = passed && done && jston::to_json_string(loaded) == jston::to_json_string(level1);
+    std::cout << "Level1 encoded in " << chunks << " chunks and decoded back" << std::endl;
+    std::cout << (passed ? "Chunked encoder verification passed!" : "Warning: chunked encoder mismatch!") << std::endl;
+#else
+    std::cout << "Coroutines are not available, build with C++20 to enable encode_chunks" << std::endl;
+#endif
+}
+
 int main() {
     std::cout << "=== JSON Translator Framework Example Program ===" << std::endl;
 
@@ -541,6 +1699,86 @@ int main() {
 
     // test 5-level nested struct array
     test_deep_nested_struct_array();
+    print_separator();
+
+    // test field projection with a compiled field mask
+    test_field_mask();
+    print_separator();
+
+    // test lazy partial decode of selected fields from JSON text
+    test_partial_decode();
+    print_separator();
+
+    // test registration without static initializers
+    test_lazy_registration();
+    print_separator();
+
+    // test that to_json and to_json_string agree
+    test_encoder_agreement();
+    print_separator();
+
+    // test std::string and std::string_view fields
+    test_std_string_fields();
+    print_separator();
+
+    // test std::vector fields
+    test_vector_fields();
+    print_separator();
+
+    // test fixed arrays bound to a count field
+    test_counted_arrays();
+    print_separator();
+
+    // test std::optional fields
+    test_optional_fields();
+    print_separator();
+
+    // test enum fields
+    test_enum_fields();
+    print_separator();
+
+    // test std::map, std::unordered_map and flat map fields
+    test_map_fields();
+    print_separator();
+
+    // test multi-dimensional array fields
+    test_multi_dimensional_arrays();
+    print_separator();
+
+    // test integer arrays of all widths and byte blobs
+    test_byte_arrays();
+    print_separator();
+
+    // test registration order keys and order speculating decode
+    test_key_order();
+    print_separator();
+
+    // test worst-case JSON size and stack buffer serialization
+    test_max_json_size();
+    print_separator();
+
+    // test exact float and double parsing
+    test_floating_parse();
+    print_separator();
+
+    // test range checked integer parsing
+    test_integer_parse();
+    print_separator();
+
+    // test skipping large unselected values
+    test_bulk_skip();
+    print_separator();
+
+    // test the on-demand cursor
+    test_cursor();
+    print_separator();
+
+    // test decoding a message that arrives in pieces
+    test_push_decoder();
+    print_separator();
+
+    // test encoding a struct in chunks
+    test_encode_chunks();
 
     std::cout << "\n=== Example Program Completed ===" << std::endl;
     return 0;